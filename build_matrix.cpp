@@ -0,0 +1,240 @@
+/**
+ * @file build_matrix.cpp
+ * @brief Builds great-circle or Euclidean distance matrices from node coordinates.
+ *
+ * This is the offline fallback for the openrouteservice distance matrix. The input file holds the
+ * number of nodes followed by one "longitude latitude" (or "x y") pair per line, the same format as
+ * the data/coords_<i>.txt files read by solve_tsp.cpp. The output is written in the text format of
+ * data/matrix_<i>.txt or, when the output name ends with ".bin", in the binary format
+ * (int32 size followed by the row-major float64 entries).
+ *
+ * Rows are computed in bands by several threads; within a row the coordinates are read from
+ * structure-of-arrays buffers so that the distance kernel vectorises. Build with
+ * -O3 -march=native -ffast-math to let the compiler use the vector math library for asin.
+ */
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <fstream>
+#include <charconv>
+#include <cfloat>
+#include <cstdint>
+#include <string>
+#include <chrono>
+using namespace std;
+
+const double EARTH_RADIUS = 6371008.8; ///< Mean earth radius in metres
+const double PI = 3.14159265358979323846;
+const int BAND_ROWS = 64;              ///< Rows handed to a thread at a time
+
+/**
+ * @brief Coordinates of the nodes stored as a structure of arrays.
+ * @note For great-circle distances the nodes are stored as unit vectors (x, y, z); for Euclidean
+ *       distances z is zero and x, y are the raw coordinates.
+ */
+struct Points {
+    vector<double> x, y, z;
+};
+
+/**
+ * @brief Reads node coordinates from a file.
+ * @param filename The file holding the number of nodes followed by one coordinate pair per line.
+ * @param greatCircle Whether to convert (longitude, latitude) in degrees to unit vectors.
+ * @param points Receives the coordinates.
+ * @return True if the file could be read, false otherwise.
+ */
+bool readPoints(const string& filename, bool greatCircle, Points& points) {
+    ifstream inputFile(filename);
+    if (!inputFile) return false;
+
+    int n;
+    if (!(inputFile >> n) || n < 0) return false;
+    points.x.resize(n);
+    points.y.resize(n);
+    points.z.assign(n, 0.0);
+
+    for (int i = 0; i < n; ++i) {
+        double first, second;
+        if (!(inputFile >> first >> second)) return false;
+        if (greatCircle) {
+            double lon = first * PI / 180, lat = second * PI / 180;
+            points.x[i] = cos(lat) * cos(lon);
+            points.y[i] = cos(lat) * sin(lon);
+            points.z[i] = sin(lat);
+        } else {
+            points.x[i] = first;
+            points.y[i] = second;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Computes one row of the great-circle distance matrix.
+ *
+ * The central angle follows from the chord length c between the unit vectors as 2 asin(c / 2),
+ * which needs a single transcendental call per entry and no data-dependent branches.
+ *
+ * @param points The nodes as unit vectors.
+ * @param i The row to compute.
+ * @param scale Factor converting metres to the output unit.
+ * @param row Receives the n entries of the row.
+ */
+void greatCircleRow(const Points& points, int i, double scale, double* __restrict row) {
+    const double* __restrict x = points.x.data();
+    const double* __restrict y = points.y.data();
+    const double* __restrict z = points.z.data();
+    const double xi = x[i], yi = y[i], zi = z[i];
+    const double factor = 2 * EARTH_RADIUS * scale;
+    const int n = static_cast<int>(points.x.size());
+
+    for (int j = 0; j < n; ++j) {
+        double dx = x[j] - xi, dy = y[j] - yi, dz = z[j] - zi;
+        double halfChord = 0.5 * sqrt(dx * dx + dy * dy + dz * dz);
+        row[j] = factor * asin(halfChord < 1.0 ? halfChord : 1.0);
+    }
+}
+
+/**
+ * @brief Computes one row of the Euclidean distance matrix.
+ * @param points The node coordinates.
+ * @param i The row to compute.
+ * @param scale Factor converting coordinate units to the output unit.
+ * @param row Receives the n entries of the row.
+ */
+void euclideanRow(const Points& points, int i, double scale, double* __restrict row) {
+    const double* __restrict x = points.x.data();
+    const double* __restrict y = points.y.data();
+    const double xi = x[i], yi = y[i];
+    const int n = static_cast<int>(points.x.size());
+
+    for (int j = 0; j < n; ++j) {
+        double dx = x[j] - xi, dy = y[j] - yi;
+        row[j] = scale * sqrt(dx * dx + dy * dy);
+    }
+}
+
+/**
+ * @brief Formats one matrix row in the text format used by data/matrix_<i>.txt.
+ * @param row The entries of the row.
+ * @param n The number of entries.
+ * @param text Receives the formatted line.
+ */
+void formatRow(const double* row, int n, string& text) {
+    char buffer[DBL_MAX_10_EXP + 5]; ///< Sign, the 309 digits of DBL_MAX, the point and one decimal
+    text.clear();
+    for (int j = 0; j < n; ++j) {
+        to_chars_result result = to_chars(buffer, buffer + sizeof(buffer), row[j], chars_format::fixed, 1);
+        if (result.ec == errc()) text.append(buffer, result.ptr);
+        text += j + 1 < n ? ' ' : '\n';
+    }
+}
+
+/**
+ * @brief Main function to read coordinates, build the distance matrix and save it.
+ * @return 0 on successful execution, non-zero on error.
+ * @param argc The number of command-line arguments.
+ * @param argv The command-line arguments.
+ * @note Usage: build_matrix <coordinates file> <output file> [--euclidean] [--speed <km/h>] [--threads <count>]
+ *       With --speed the matrix holds travel durations in seconds instead of distances in metres.
+ */
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        cerr << "Usage: " << argv[0] << " <coordinates file> <output file> [--euclidean] [--speed <km/h>] [--threads <count>]" << endl;
+        return 1;
+    }
+
+    string inputFilename = argv[1];
+    string outputFilename = argv[2];
+    bool greatCircle = true;
+    double scale = 1.0;
+    int numThreads = max(1u, thread::hardware_concurrency());
+
+    for (int i = 3; i < argc; ++i) {
+        string option = argv[i];
+        if (option == "--euclidean") {
+            greatCircle = false;
+        } else if (option == "--speed" && i + 1 < argc) {
+            scale = 3.6 / stod(argv[++i]); // metres to seconds at the given km/h
+        } else if (option == "--threads" && i + 1 < argc) {
+            numThreads = max(1, stoi(argv[++i]));
+        } else {
+            cerr << "Error: Unknown option " << option << endl;
+            return 1;
+        }
+    }
+
+    Points points;
+    if (!readPoints(inputFilename, greatCircle, points)) {
+        cerr << "Error: Coordinates could not be read from " << inputFilename << endl;
+        return 1;
+    }
+    int n = static_cast<int>(points.x.size());
+    bool binary = outputFilename.size() >= 4 && outputFilename.compare(outputFilename.size() - 4, 4, ".bin") == 0;
+
+    ofstream outputFile(outputFilename, binary ? ios::binary : ios::out);
+    if (!outputFile) {
+        cerr << "Error: Could not open the file for writing!" << endl;
+        return 1;
+    }
+
+    auto start = chrono::high_resolution_clock::now();
+
+    if (binary) {
+        int32_t size = n;
+        outputFile.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    } else {
+        outputFile << n << "\n";
+    }
+
+    // Rows are produced in bands: the threads fill a band, then it is written out in order
+    int bandSize = BAND_ROWS * numThreads;
+    vector<double> band(static_cast<size_t>(min(bandSize, max(n, 1))) * n);
+    vector<string> text(binary ? 0 : min(bandSize, max(n, 1)));
+
+    for (int bandStart = 0; bandStart < n; bandStart += bandSize) {
+        int bandEnd = min(n, bandStart + bandSize);
+        atomic<int> nextTile(bandStart);
+
+        auto worker = [&]() {
+            while (true) {
+                int tileStart = nextTile.fetch_add(BAND_ROWS);
+                if (tileStart >= bandEnd) break;
+                int tileEnd = min(bandEnd, tileStart + BAND_ROWS);
+                for (int i = tileStart; i < tileEnd; ++i) {
+                    double* row = band.data() + static_cast<size_t>(i - bandStart) * n;
+                    if (greatCircle) greatCircleRow(points, i, scale, row);
+                    else euclideanRow(points, i, scale, row);
+                    row[i] = 0.0;
+                    if (!binary) formatRow(row, n, text[i - bandStart]);
+                }
+            }
+        };
+
+        vector<thread> threads;
+        for (int t = 1; t < numThreads; ++t) threads.emplace_back(worker);
+        worker();
+        for (auto& t : threads) t.join();
+
+        if (binary) {
+            outputFile.write(reinterpret_cast<const char*>(band.data()), static_cast<streamsize>(sizeof(double)) * (bandEnd - bandStart) * n);
+        } else {
+            for (int i = bandStart; i < bandEnd; ++i) outputFile << text[i - bandStart];
+        }
+    }
+
+    outputFile.close();
+    if (!outputFile) {
+        cerr << "Error: Could not write " << outputFilename << endl;
+        return 1;
+    }
+
+    auto end = chrono::high_resolution_clock::now();
+    auto duration = chrono::duration_cast<chrono::milliseconds>(end - start);
+    cout << "Matrix of size " << n << " saved to " << outputFilename << " in " << duration.count() << "ms" << endl;
+    return 0;
+}
@@ -1,4 +1,7 @@
-from solve_tsp import *
+try:
+    from tsp_native import *  # Native solvers built from tsp_native.cpp
+except ImportError:
+    from solve_tsp import *
 import folium
 import routing
 import os
@@ -7,9 +10,10 @@ import sys
 #This program reads a list of addresses from "adresses.txt" file and calculates the shortest route to visit all of them using different algorithms
 #The output is saved in a html file for each algorithm
 #The program uses the openrouteservice API to get the coordinates and the distance matrix for the locations
-#The program uses the solve_tsp.py to calculate the shortest route using different algorithms
+#The program uses the solve_tsp.py (or the native tsp_native module when it is built) to calculate the shortest route using different algorithms
 #The program uses the folium library to create the map and display the route
 #The program uses the dotenv library to load the API key from a .env file
+#Route geometry of each leg is cached in the "cache" folder, so only legs never seen before are fetched
 
 def main(args):
     load_dotenv()  
@@ -56,7 +60,7 @@ def main(args):
             c = colors[i%len(colors)]
             route = [locations[r[i]],locations[r[i+1]]]
             folium.Marker(route[0][::-1], popup=f"Location {i}").add_to(m)
-            cords = routing.get_route(client,route)
+            cords = routing.get_route_cached(client,route)
             folium.PolyLine(cords, color=c, weight=3, opacity=0.8).add_to(m)
         
         m.save(f"{alg.__name__}.html")
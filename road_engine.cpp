@@ -0,0 +1,537 @@
+/**
+ * @file road_engine.cpp
+ * @brief Local many-to-many duration engine over a road graph using contraction hierarchies.
+ *
+ * This is the offline replacement for the openrouteservice duration matrix. The road graph is read
+ * from a simple edge list (the number of nodes and edges followed by one "from to duration" line per
+ * directed edge), contracted once, and then queried with the bucket-based many-to-many algorithm:
+ * one upward backward search per target fills the buckets, one upward forward search per source
+ * scans them. The output is written in the text or binary matrix format read by solve_tsp.cpp.
+ */
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <queue>
+#include <random>
+#include <thread>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <cstdint>
+#include <cfloat>
+#include <string>
+#include <chrono>
+using namespace std;
+
+const int WITNESS_SETTLE_LIMIT = 500; ///< Nodes settled by a witness search before giving up
+const int ESTIMATE_SETTLE_LIMIT = 30; ///< Settle limit of the witness searches that only estimate priorities
+
+/**
+ * @brief A directed edge of the road graph.
+ */
+struct Edge {
+    int to;          ///< Head of the edge
+    double duration; ///< Travel duration along the edge
+};
+
+/**
+ * @brief A road graph contracted into a hierarchy for many-to-many duration queries.
+ */
+class ContractionHierarchy {
+public:
+    /**
+     * @brief Contracts the graph, ordering nodes by edge difference and contracted neighbours.
+     * @param n The number of nodes.
+     * @param edges The directed edges as (from, to, duration).
+     */
+    ContractionHierarchy(int n, const vector<tuple<int, int, double>>& edges)
+        : n(n), rank(n, -1), up(n), downReverse(n) {
+        vector<vector<Edge>> out(n), in(n);
+        for (const auto& edge : edges) {
+            int from = get<0>(edge), to = get<1>(edge);
+            if (from == to) continue;
+            addEdge(out, in, from, to, get<2>(edge));
+        }
+        contract(out, in);
+    }
+
+    /**
+     * @brief Computes the shortest durations between every source and every target.
+     * @param sources The source nodes (matrix rows).
+     * @param targets The target nodes (matrix columns).
+     * @param numThreads The number of threads used for the forward searches.
+     * @return The duration matrix; unreachable pairs are DBL_MAX.
+     */
+    vector<vector<double>> manyToMany(const vector<int>& sources, const vector<int>& targets, int numThreads) const {
+        // Backward upward search from every target fills the buckets of the settled nodes
+        vector<vector<pair<int, double>>> buckets(n); ///< (target column, duration to that target)
+        vector<double> distance(n, DBL_MAX);
+        vector<int> settled;
+        for (size_t column = 0; column < targets.size(); ++column) {
+            upwardSearch(targets[column], downReverse, distance, settled);
+            for (int node : settled) {
+                buckets[node].push_back({static_cast<int>(column), distance[node]});
+                distance[node] = DBL_MAX;
+            }
+        }
+
+        // Forward upward search from every source scans the buckets
+        vector<vector<double>> matrix(sources.size(), vector<double>(targets.size(), DBL_MAX));
+        atomic<int> nextRow(0);
+        auto worker = [&]() {
+            vector<double> forward(n, DBL_MAX);
+            vector<int> reached;
+            for (int row = nextRow++; row < static_cast<int>(sources.size()); row = nextRow++) {
+                upwardSearch(sources[row], up, forward, reached);
+                for (int node : reached) {
+                    for (const auto& entry : buckets[node]) {
+                        double total = forward[node] + entry.second;
+                        if (total < matrix[row][entry.first]) matrix[row][entry.first] = total;
+                    }
+                    forward[node] = DBL_MAX;
+                }
+            }
+        };
+
+        vector<thread> threads;
+        for (int t = 1; t < numThreads; ++t) threads.emplace_back(worker);
+        worker();
+        for (auto& t : threads) t.join();
+        return matrix;
+    }
+
+    /**
+     * @brief Returns the number of shortcut edges added during contraction.
+     */
+    long long shortcuts() const { return numShortcuts; }
+
+private:
+    int n;
+    vector<int> rank;                ///< Contraction order of each node
+    vector<vector<Edge>> up;         ///< Edges to higher-ranked nodes
+    vector<vector<Edge>> downReverse; ///< Reversed edges from higher-ranked nodes
+    long long numShortcuts = 0;
+
+    // Scratch space of the witness searches, reset lazily by generation stamps
+    vector<double> witnessDistance;
+    vector<int> witnessStamp;
+    int generation = 0;
+
+    static void addEdge(vector<vector<Edge>>& out, vector<vector<Edge>>& in, int from, int to, double duration) {
+        for (auto& edge : out[from]) {
+            if (edge.to == to) {
+                if (duration < edge.duration) {
+                    edge.duration = duration;
+                    for (auto& reverse : in[to]) {
+                        if (reverse.to == from) reverse.duration = duration;
+                    }
+                }
+                return;
+            }
+        }
+        out[from].push_back({to, duration});
+        in[to].push_back({from, duration});
+    }
+
+    /**
+     * @brief Runs a bounded Dijkstra search from source that avoids the node being contracted.
+     * @return Nothing; witnessDistance holds the durations of the nodes reached in this generation.
+     */
+    void witnessSearch(const vector<vector<Edge>>& out, int source, int avoid, double limit, int settleLimit) {
+        ++generation;
+        using Entry = pair<double, int>;
+        priority_queue<Entry, vector<Entry>, greater<Entry>> queue;
+        witnessDistance[source] = 0;
+        witnessStamp[source] = generation;
+        queue.push({0, source});
+        int settledCount = 0;
+
+        while (!queue.empty()) {
+            auto [duration, node] = queue.top();
+            queue.pop();
+            if (duration > witnessDistance[node]) continue;
+            if (duration > limit || ++settledCount > settleLimit) break;
+            for (const auto& edge : out[node]) {
+                if (edge.to == avoid || rank[edge.to] != -1) continue;
+                double next = duration + edge.duration;
+                if (witnessStamp[edge.to] != generation || next < witnessDistance[edge.to]) {
+                    witnessStamp[edge.to] = generation;
+                    witnessDistance[edge.to] = next;
+                    queue.push({next, edge.to});
+                }
+            }
+        }
+    }
+
+    double witness(int node) const {
+        return witnessStamp[node] == generation ? witnessDistance[node] : DBL_MAX;
+    }
+
+    /**
+     * @brief Finds (or only counts) the shortcuts needed to contract a node.
+     * @param shortcutsOut Receives the shortcuts as (from, to, duration); when null the count is
+     *        only estimated with cheaper witness searches.
+     * @return The number of shortcuts needed.
+     */
+    int shortcutsFor(const vector<vector<Edge>>& out, const vector<vector<Edge>>& in, int node, vector<tuple<int, int, double>>* shortcutsOut) {
+        int count = 0;
+        double maxOut = 0;
+        for (const auto& edge : out[node]) {
+            if (rank[edge.to] == -1) maxOut = max(maxOut, edge.duration);
+        }
+
+        for (const auto& incoming : in[node]) {
+            int from = incoming.to;
+            if (rank[from] != -1) continue;
+            witnessSearch(out, from, node, incoming.duration + maxOut, shortcutsOut ? WITNESS_SETTLE_LIMIT : ESTIMATE_SETTLE_LIMIT);
+            for (const auto& outgoing : out[node]) {
+                int to = outgoing.to;
+                if (rank[to] != -1 || to == from) continue;
+                double viaNode = incoming.duration + outgoing.duration;
+                if (witness(to) > viaNode) {
+                    ++count;
+                    if (shortcutsOut) shortcutsOut->emplace_back(from, to, viaNode);
+                }
+            }
+        }
+        return count;
+    }
+
+    static int degree(const vector<vector<Edge>>& edges, const vector<int>& rank, int node) {
+        int count = 0;
+        for (const auto& edge : edges[node]) {
+            if (rank[edge.to] == -1) ++count;
+        }
+        return count;
+    }
+
+    int priority(const vector<vector<Edge>>& out, const vector<vector<Edge>>& in, const vector<int>& contractedNeighbours, int node) {
+        int added = shortcutsFor(out, in, node, nullptr);
+        int removed = degree(out, rank, node) + degree(in, rank, node);
+        return added - removed + contractedNeighbours[node];
+    }
+
+    void contract(vector<vector<Edge>>& out, vector<vector<Edge>>& in) {
+        witnessDistance.assign(n, DBL_MAX);
+        witnessStamp.assign(n, 0);
+        vector<int> contractedNeighbours(n, 0);
+
+        using Entry = pair<int, int>;
+        priority_queue<Entry, vector<Entry>, greater<Entry>> queue;
+        for (int node = 0; node < n; ++node) {
+            queue.push({priority(out, in, contractedNeighbours, node), node});
+        }
+
+        int order = 0;
+        vector<tuple<int, int, double>> added;
+        while (!queue.empty()) {
+            int node = queue.top().second;
+            queue.pop();
+            if (rank[node] != -1) continue;
+
+            // Lazy update: contract only if the node is still the cheapest one
+            int current = priority(out, in, contractedNeighbours, node);
+            if (!queue.empty() && current > queue.top().first) {
+                queue.push({current, node});
+                continue;
+            }
+
+            added.clear();
+            shortcutsFor(out, in, node, &added);
+            for (const auto& edge : out[node]) {
+                if (rank[edge.to] == -1) up[node].push_back(edge);
+            }
+            for (const auto& edge : in[node]) {
+                if (rank[edge.to] == -1) downReverse[node].push_back(edge);
+            }
+            rank[node] = order++;
+
+            for (const auto& shortcut : added) {
+                addEdge(out, in, get<0>(shortcut), get<1>(shortcut), get<2>(shortcut));
+            }
+            numShortcuts += static_cast<long long>(added.size());
+
+            // Neighbours lose an edge each and have their priorities refreshed
+            vector<int> neighbours;
+            for (const auto& edge : out[node]) neighbours.push_back(edge.to);
+            for (const auto& edge : in[node]) neighbours.push_back(edge.to);
+            sort(neighbours.begin(), neighbours.end());
+            neighbours.erase(unique(neighbours.begin(), neighbours.end()), neighbours.end());
+            for (int neighbour : neighbours) {
+                if (rank[neighbour] != -1) continue;
+                ++contractedNeighbours[neighbour];
+                queue.push({priority(out, in, contractedNeighbours, neighbour), neighbour});
+            }
+            // Drop the contracted node from the remaining graph to keep adjacency scans short
+            for (const auto& edge : out[node]) {
+                auto& reverse = in[edge.to];
+                reverse.erase(remove_if(reverse.begin(), reverse.end(), [node](const Edge& e) { return e.to == node; }), reverse.end());
+            }
+            for (const auto& edge : in[node]) {
+                auto& forward = out[edge.to];
+                forward.erase(remove_if(forward.begin(), forward.end(), [node](const Edge& e) { return e.to == node; }), forward.end());
+            }
+            out[node].clear();
+            in[node].clear();
+        }
+    }
+
+    /**
+     * @brief Runs a Dijkstra search restricted to edges towards higher-ranked nodes.
+     * @param distance Must be DBL_MAX everywhere; the caller resets the settled entries.
+     * @param settled Receives the settled nodes.
+     */
+    static void upwardSearch(int source, const vector<vector<Edge>>& edges, vector<double>& distance, vector<int>& settled) {
+        using Entry = pair<double, int>;
+        priority_queue<Entry, vector<Entry>, greater<Entry>> queue;
+        settled.clear();
+        distance[source] = 0;
+        queue.push({0, source});
+
+        // Every reached node is eventually settled, so resetting the settled nodes restores distance
+        while (!queue.empty()) {
+            auto [duration, node] = queue.top();
+            queue.pop();
+            if (duration > distance[node]) continue;
+            settled.push_back(node);
+            for (const auto& edge : edges[node]) {
+                double next = duration + edge.duration;
+                if (next < distance[edge.to]) {
+                    distance[edge.to] = next;
+                    queue.push({next, edge.to});
+                }
+            }
+        }
+    }
+};
+
+/**
+ * @brief Computes shortest durations from one source with a plain Dijkstra search.
+ * @param n The number of nodes.
+ * @param out The outgoing edges of every node.
+ * @param source The source node.
+ * @return The duration to every node; unreachable nodes are DBL_MAX.
+ */
+vector<double> dijkstra(int n, const vector<vector<Edge>>& out, int source) {
+    vector<double> distance(n, DBL_MAX);
+    using Entry = pair<double, int>;
+    priority_queue<Entry, vector<Entry>, greater<Entry>> queue;
+    distance[source] = 0;
+    queue.push({0, source});
+    while (!queue.empty()) {
+        auto [duration, node] = queue.top();
+        queue.pop();
+        if (duration > distance[node]) continue;
+        for (const auto& edge : out[node]) {
+            if (duration + edge.duration < distance[edge.to]) {
+                distance[edge.to] = duration + edge.duration;
+                queue.push({distance[edge.to], edge.to});
+            }
+        }
+    }
+    return distance;
+}
+
+/**
+ * @brief Reads a road graph from an edge list.
+ * @param filename The file holding "nodes edges" followed by one "from to duration" line per edge.
+ * @param n Receives the number of nodes.
+ * @param edges Receives the directed edges.
+ * @return True if the file could be read, false otherwise.
+ */
+bool readGraph(const string& filename, int& n, vector<tuple<int, int, double>>& edges) {
+    ifstream inputFile(filename);
+    if (!inputFile) return false;
+
+    long long m;
+    if (!(inputFile >> n >> m) || n < 0 || m < 0) return false;
+    edges.resize(m);
+    for (auto& edge : edges) {
+        int from, to;
+        double duration;
+        if (!(inputFile >> from >> to >> duration)) return false;
+        if (from < 0 || from >= n || to < 0 || to >= n || duration < 0) return false;
+        edge = make_tuple(from, to, duration);
+    }
+    return true;
+}
+
+/**
+ * @brief Reads the stops whose duration matrix is requested.
+ * @param filename The file holding the number of stops followed by one node index per line.
+ * @param n The number of nodes of the graph.
+ * @param stops Receives the node indices.
+ * @return True if the file could be read, false otherwise.
+ */
+bool readStops(const string& filename, int n, vector<int>& stops) {
+    ifstream inputFile(filename);
+    if (!inputFile) return false;
+
+    int count;
+    if (!(inputFile >> count) || count < 0) return false;
+    stops.resize(count);
+    for (int& stop : stops) {
+        if (!(inputFile >> stop) || stop < 0 || stop >= n) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Generates a synthetic grid road graph with random, slightly asymmetric durations.
+ * @param width The number of columns of the grid.
+ * @param height The number of rows of the grid.
+ * @param gen The random number generator.
+ * @param edges Receives the directed edges.
+ * @return The number of nodes.
+ */
+int generateGrid(int width, int height, mt19937& gen, vector<tuple<int, int, double>>& edges) {
+    uniform_real_distribution<double> duration(10.0, 100.0);
+    uniform_real_distribution<double> asymmetry(0.9, 1.1);
+    auto id = [width](int x, int y) { return y * width + x; };
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            if (x + 1 < width) {
+                double d = duration(gen);
+                edges.emplace_back(id(x, y), id(x + 1, y), d);
+                edges.emplace_back(id(x + 1, y), id(x, y), d * asymmetry(gen));
+            }
+            if (y + 1 < height) {
+                double d = duration(gen);
+                edges.emplace_back(id(x, y), id(x, y + 1), d);
+                edges.emplace_back(id(x, y + 1), id(x, y), d * asymmetry(gen));
+            }
+        }
+    }
+    return width * height;
+}
+
+/**
+ * @brief Writes a matrix in the text or binary format read by solve_tsp.cpp.
+ * @param filename The output file; names ending with ".bin" select the binary format.
+ * @param matrix The square matrix to write; every entry must be finite.
+ * @return True if the file could be written, false otherwise.
+ */
+bool writeMatrix(const string& filename, const vector<vector<double>>& matrix) {
+    bool binary = filename.size() >= 4 && filename.compare(filename.size() - 4, 4, ".bin") == 0;
+    ofstream outputFile(filename, binary ? ios::binary : ios::out);
+    if (!outputFile) return false;
+
+    int32_t size = static_cast<int32_t>(matrix.size());
+    if (binary) {
+        outputFile.write(reinterpret_cast<const char*>(&size), sizeof(size));
+        for (const auto& row : matrix) {
+            outputFile.write(reinterpret_cast<const char*>(row.data()), static_cast<streamsize>(sizeof(double)) * size);
+        }
+    } else {
+        outputFile << size << "\n" << fixed << setprecision(1);
+        for (const auto& row : matrix) {
+            for (int j = 0; j < size; ++j) {
+                outputFile << row[j] << (j + 1 < size ? ' ' : '\n');
+            }
+        }
+    }
+    return static_cast<bool>(outputFile);
+}
+
+/**
+ * @brief Main function to build the hierarchy, compute the duration matrix and save it.
+ * @return 0 on successful execution, non-zero on error.
+ * @param argc The number of command-line arguments.
+ * @param argv The command-line arguments.
+ * @note Usage: road_engine <graph file> <stops file> <output file> [--verify] [--threads <count>]
+ *          or: road_engine --grid <width> <height> <number of stops> <output file> [--verify] [--threads <count>]
+ *       --verify checks every entry against a plain Dijkstra search on the original graph.
+ *       Fails without writing the output when some stop cannot reach another.
+ */
+int main(int argc, char* argv[]) {
+    int n = 0;
+    vector<tuple<int, int, double>> edges;
+    vector<int> stops;
+    string outputFilename;
+    int next;
+
+    if (argc >= 6 && string(argv[1]) == "--grid") {
+        mt19937 gen(42); ///< Fixed seed so that grid runs are repeatable
+        n = generateGrid(stoi(argv[2]), stoi(argv[3]), gen, edges);
+        uniform_int_distribution<int> node(0, n - 1);
+        stops.resize(stoi(argv[4]));
+        for (int& stop : stops) stop = node(gen);
+        outputFilename = argv[5];
+        next = 6;
+    } else if (argc >= 4) {
+        if (!readGraph(argv[1], n, edges)) {
+            cerr << "Error: Graph could not be read from " << argv[1] << endl;
+            return 1;
+        }
+        if (!readStops(argv[2], n, stops)) {
+            cerr << "Error: Stops could not be read from " << argv[2] << endl;
+            return 1;
+        }
+        outputFilename = argv[3];
+        next = 4;
+    } else {
+        cerr << "Usage: " << argv[0] << " <graph file> <stops file> <output file> [--verify] [--threads <count>]" << endl;
+        cerr << "       " << argv[0] << " --grid <width> <height> <number of stops> <output file> [--verify] [--threads <count>]" << endl;
+        return 1;
+    }
+
+    bool verify = false;
+    int numThreads = max(1u, thread::hardware_concurrency());
+    for (int i = next; i < argc; ++i) {
+        string option = argv[i];
+        if (option == "--verify") {
+            verify = true;
+        } else if (option == "--threads" && i + 1 < argc) {
+            numThreads = max(1, stoi(argv[++i]));
+        } else {
+            cerr << "Error: Unknown option " << option << endl;
+            return 1;
+        }
+    }
+
+    auto start = chrono::high_resolution_clock::now();
+    ContractionHierarchy hierarchy(n, edges);
+    auto built = chrono::high_resolution_clock::now();
+    cout << "Contracted " << n << " nodes with " << hierarchy.shortcuts() << " shortcuts in "
+         << chrono::duration_cast<chrono::milliseconds>(built - start).count() << "ms" << endl;
+
+    vector<vector<double>> matrix = hierarchy.manyToMany(stops, stops, numThreads);
+    auto queried = chrono::high_resolution_clock::now();
+    cout << "Computed " << stops.size() << "x" << stops.size() << " durations in "
+         << chrono::duration_cast<chrono::milliseconds>(queried - built).count() << "ms" << endl;
+
+    // The matrix formats have no encoding for a missing route, so disconnected stops are an error
+    long long unreachable = 0;
+    for (const auto& row : matrix) unreachable += count(row.begin(), row.end(), DBL_MAX);
+    if (unreachable > 0) {
+        cerr << "Error: " << unreachable << " stop pairs are not connected in the graph" << endl;
+        return 1;
+    }
+
+    if (verify) {
+        vector<vector<Edge>> out(n);
+        for (const auto& edge : edges) out[get<0>(edge)].push_back({get<1>(edge), get<2>(edge)});
+        int mismatches = 0;
+        for (size_t row = 0; row < stops.size(); ++row) {
+            vector<double> expected = dijkstra(n, out, stops[row]);
+            for (size_t column = 0; column < stops.size(); ++column) {
+                double reference = expected[stops[column]];
+                if (fabs(reference - matrix[row][column]) > 1e-6 * max(1.0, reference)) ++mismatches;
+            }
+        }
+        if (mismatches > 0) {
+            cerr << "Error: " << mismatches << " durations differ from Dijkstra" << endl;
+            return 1;
+        }
+        cout << "All durations match Dijkstra" << endl;
+    }
+
+    if (!writeMatrix(outputFilename, matrix)) {
+        cerr << "Error: Could not open the file for writing!" << endl;
+        return 1;
+    }
+    cout << "Results saved to " << outputFilename << endl;
+    return 0;
+}
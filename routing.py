@@ -1,5 +1,8 @@
 import openrouteservice
 import requests
+import hashlib
+import json
+import os
 
 
 def make_client(api_key):
@@ -29,12 +32,34 @@ def get_distance_matrix(client, coordinates):
     )
     return distances
 
-def get_route(client, coordinates):
+def get_route(client, coordinates, profile='driving-car'):
     route = client.directions(
         coordinates=coordinates, 
-        profile = 'driving-car',
+        profile = profile,
         format = 'geojson'  
     )
     geometry = route['features'][0]['geometry']['coordinates']
     geometry = [(cord[1], cord[0]) for cord in geometry]
+    return geometry
+
+def leg_key(coordinates, profile='driving-car'):
+    # Content address of a leg: rounding to ~0.1 m keeps float noise from splitting entries
+    origin, destination = coordinates
+    text = json.dumps([profile, [round(c, 6) for c in origin], [round(c, 6) for c in destination]])
+    return hashlib.sha256(text.encode()).hexdigest()
+
+def get_route_cached(client, coordinates, profile='driving-car', cache_dir='cache/legs'):
+    # Legs are stored one file per key, so repeated legs are only fetched once across runs
+    key = leg_key(coordinates, profile)
+    path = os.path.join(cache_dir, key[:2], key + '.json')
+    if os.path.exists(path):
+        with open(path, 'r') as f:
+            return [tuple(cord) for cord in json.load(f)]
+
+    geometry = get_route(client, coordinates, profile)
+    os.makedirs(os.path.dirname(path), exist_ok=True)
+    tmp_path = path + '.tmp'
+    with open(tmp_path, 'w') as f:
+        json.dump(geometry, f)
+    os.replace(tmp_path, path)  # Atomic, so an interrupted run never leaves a truncated entry
     return geometry
\ No newline at end of file
@@ -20,238 +20,3986 @@
 #include <string>
 #include "json.hpp"
 #include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <atomic>
+#include <sstream>
+#include <array>
+#include <queue>
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
 using json = nlohmann::json; ///< Alias for the JSON library
 using namespace std;
 
+/**
+ * @brief Read-only view of a square distance matrix that does not own its entries.
+ *
+ * Solvers index it like a nested vector (matrix[i][j]). It is built either from the rows of a
+ * vector<vector<double>> or from a strided row-major buffer, such as a NumPy array, without copying.
+ */
+class MatrixView {
+public:
+    /**
+     * @brief Views the rows of a nested vector.
+     * @param matrix The matrix to view; it must outlive the view.
+     */
+    MatrixView(const vector<vector<double>>& matrix) : rows(matrix.size()) {
+        for (size_t i = 0; i < matrix.size(); ++i) rows[i] = matrix[i].data();
+    }
+
+    /**
+     * @brief Views a buffer whose rows are contiguous but may be spaced apart.
+     * @param data The first entry of the first row; the buffer must outlive the view.
+     * @param n The number of rows and columns.
+     * @param rowStride The distance between the starts of consecutive rows, in entries.
+     */
+    MatrixView(const double* data, int n, ptrdiff_t rowStride) : rows(n) {
+        for (int i = 0; i < n; ++i) rows[i] = data + i * rowStride;
+    }
+
+    const double* operator[](size_t i) const { return rows[i]; }
+
+    int size() const { return static_cast<int>(rows.size()); }
+
+private:
+    vector<const double*> rows; ///< Start of each row
+};
+
 /**
  * @brief Calculates the total duration of a given TSP route.
  * @param route A vector representing the sequence of nodes in the route.
  * @param matrix A 2D matrix representing distances between nodes.
  * @return The total duration of the route.
  */
-double calculateTotalDuration(const vector<int>& route, const vector<vector<double>>& matrix) {
+double calculateTotalDuration(const vector<int>& route, const MatrixView& matrix) {
     double totalDuration = 0;
     for (size_t i = 0; i < route.size() - 1; ++i) {
         totalDuration += matrix[route[i]][route[i + 1]];
     }
-    totalDuration += matrix[route.back()][route[0]]; // Add return to the starting point
-    return totalDuration;
+    totalDuration += matrix[route.back()][route[0]]; // Add return to the starting point
+    return totalDuration;
+}
+
+/**
+ * @brief Solves the TSP using the Nearest Neighbor algorithm.
+ * @param matrix A 2D matrix representing distances between nodes.
+ * @param n The number of nodes in the graph.
+ * @return A pair consisting of the optimal route and its total duration.
+ */
+pair<vector<int>, double> nearestNeighbour(const MatrixView& matrix, int n) {
+    vector<bool> visited(n, false); ///< Tracks visited nodes
+    vector<int> route = {0};        ///< Start from the first node
+    visited[0] = true;
+    double total = 0;
+
+    for (int step = 0; step < n - 1; ++step) {
+        int current = route.back(); ///< Current location
+        double minDuration = DBL_MAX;
+        int nextLocation = -1;
+
+        // Find the nearest unvisited neighbor
+        for (int i = 0; i < n; ++i) {
+            if (!visited[i] && matrix[current][i] < minDuration) {
+                minDuration = matrix[current][i];
+                nextLocation = i;
+            }
+        }
+
+        route.push_back(nextLocation);
+        visited[nextLocation] = true;
+        total += minDuration;
+    }
+
+    // Add the distance back to the starting point
+    total += matrix[route.back()][0];
+    route.push_back(0); // Complete the route by returning to the start
+    return {route, total};
+}
+
+/**
+ * @brief Static 2-D k-d tree over node coordinates that supports removing points.
+ *
+ * Removed points are only marked; every subtree keeps a count of its live points so that
+ * queries skip exhausted branches. Repeated "nearest unvisited point" queries therefore cost
+ * about O(log n) each instead of an O(n) scan.
+ */
+class KdTree {
+public:
+    /**
+     * @brief Builds the tree over the given points in O(n log n).
+     * @param points The (x, y) coordinates of the nodes, indexed by node.
+     */
+    explicit KdTree(const vector<pair<double, double>>& points)
+        : points(points), order(points.size()), where(points.size()), axis(points.size()), alive(points.size()) {
+        iota(order.begin(), order.end(), 0);
+        build(0, static_cast<int>(order.size()));
+        for (size_t i = 0; i < order.size(); ++i) {
+            where[order[i]] = static_cast<int>(i);
+        }
+    }
+
+    /**
+     * @brief Marks a point as removed so that later queries no longer return it.
+     * @param point The index of the point to remove.
+     */
+    void remove(int point) {
+        int lo = 0, hi = static_cast<int>(order.size());
+        int position = where[point];
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            --alive[mid];
+            if (position == mid) break;
+            if (position < mid) hi = mid;
+            else lo = mid + 1;
+        }
+    }
+
+    /**
+     * @brief Finds the live point closest to the given location.
+     * @param x The x coordinate of the query.
+     * @param y The y coordinate of the query.
+     * @return The index of the nearest live point, or -1 if every point has been removed.
+     */
+    int nearest(double x, double y) const {
+        int best = -1;
+        double bestDistance = DBL_MAX;
+        searchNearest(0, static_cast<int>(order.size()), x, y, best, bestDistance);
+        return best;
+    }
+
+    /**
+     * @brief Finds the k live points closest to a given point, excluding the point itself.
+     * @param point The index of the query point.
+     * @param k The number of neighbours to return.
+     * @return The neighbours ordered from the closest to the farthest.
+     */
+    vector<int> kNearest(int point, int k) const {
+        vector<pair<double, int>> heap; ///< Max-heap of the best candidates found so far
+        searchKNearest(0, static_cast<int>(order.size()), point, k, heap);
+        sort_heap(heap.begin(), heap.end());
+        vector<int> neighbours;
+        for (const auto& entry : heap) neighbours.push_back(entry.second);
+        return neighbours;
+    }
+
+private:
+    vector<pair<double, double>> points; ///< Coordinates of the nodes
+    vector<int> order;                   ///< Node indices in tree order, subtree medians at range midpoints
+    vector<int> where;                   ///< Position of each node in order
+    vector<char> axis;                   ///< Split axis of the subtree rooted at each position
+    vector<int> alive;                   ///< Live points in the subtree rooted at each position
+
+    double coordinate(int point, int dimension) const {
+        return dimension == 0 ? points[point].first : points[point].second;
+    }
+
+    double squaredDistance(int point, double x, double y) const {
+        double dx = points[point].first - x;
+        double dy = points[point].second - y;
+        return dx * dx + dy * dy;
+    }
+
+    void build(int lo, int hi) {
+        if (lo >= hi) return;
+        // Split along the axis with the larger spread
+        double minX = DBL_MAX, maxX = -DBL_MAX, minY = DBL_MAX, maxY = -DBL_MAX;
+        for (int i = lo; i < hi; ++i) {
+            minX = min(minX, points[order[i]].first);
+            maxX = max(maxX, points[order[i]].first);
+            minY = min(minY, points[order[i]].second);
+            maxY = max(maxY, points[order[i]].second);
+        }
+        int mid = (lo + hi) / 2;
+        int dimension = (maxX - minX >= maxY - minY) ? 0 : 1;
+        nth_element(order.begin() + lo, order.begin() + mid, order.begin() + hi, [&](int a, int b) {
+            return coordinate(a, dimension) < coordinate(b, dimension);
+        });
+        axis[mid] = static_cast<char>(dimension);
+        alive[mid] = hi - lo;
+        build(lo, mid);
+        build(mid + 1, hi);
+    }
+
+    bool isAlive(int position, int lo, int hi) const {
+        int left = position - lo, right = hi - position - 1;
+        int leftAlive = left > 0 ? alive[(lo + position) / 2] : 0;
+        int rightAlive = right > 0 ? alive[(position + 1 + hi) / 2] : 0;
+        return alive[position] > leftAlive + rightAlive;
+    }
+
+    void searchNearest(int lo, int hi, double x, double y, int& best, double& bestDistance) const {
+        if (lo >= hi) return;
+        int mid = (lo + hi) / 2;
+        if (alive[mid] == 0) return;
+
+        int point = order[mid];
+        if (isAlive(mid, lo, hi)) {
+            double distance = squaredDistance(point, x, y);
+            if (distance < bestDistance) {
+                bestDistance = distance;
+                best = point;
+            }
+        }
+
+        double diff = (axis[mid] == 0 ? x : y) - coordinate(point, axis[mid]);
+        if (diff < 0) {
+            searchNearest(lo, mid, x, y, best, bestDistance);
+            if (diff * diff < bestDistance) searchNearest(mid + 1, hi, x, y, best, bestDistance);
+        } else {
+            searchNearest(mid + 1, hi, x, y, best, bestDistance);
+            if (diff * diff < bestDistance) searchNearest(lo, mid, x, y, best, bestDistance);
+        }
+    }
+
+    void searchKNearest(int lo, int hi, int query, int k, vector<pair<double, int>>& heap) const {
+        if (lo >= hi || k <= 0) return;
+        int mid = (lo + hi) / 2;
+        if (alive[mid] == 0) return;
+
+        int point = order[mid];
+        double x = points[query].first, y = points[query].second;
+        if (point != query && isAlive(mid, lo, hi)) {
+            double distance = squaredDistance(point, x, y);
+            if (static_cast<int>(heap.size()) < k) {
+                heap.push_back({distance, point});
+                push_heap(heap.begin(), heap.end());
+            } else if (distance < heap.front().first) {
+                pop_heap(heap.begin(), heap.end());
+                heap.back() = {distance, point};
+                push_heap(heap.begin(), heap.end());
+            }
+        }
+
+        double diff = (axis[mid] == 0 ? x : y) - coordinate(point, axis[mid]);
+        int nearLo = diff < 0 ? lo : mid + 1, nearHi = diff < 0 ? mid : hi;
+        int farLo = diff < 0 ? mid + 1 : lo, farHi = diff < 0 ? hi : mid;
+        searchKNearest(nearLo, nearHi, query, k, heap);
+        if (static_cast<int>(heap.size()) < k || diff * diff < heap.front().first) {
+            searchKNearest(farLo, farHi, query, k, heap);
+        }
+    }
+};
+
+/**
+ * @brief Reads node coordinates from a file.
+ * @param filename The file holding the number of nodes followed by one "x y" pair per line.
+ * @param coordinates Receives the coordinates of the nodes.
+ * @return True if the file could be read, false otherwise.
+ */
+bool readCoordinates(const string& filename, vector<pair<double, double>>& coordinates) {
+    ifstream inputFile(filename);
+    if (!inputFile) return false;
+
+    int count;
+    if (!(inputFile >> count) || count < 0) return false;
+    coordinates.assign(count, {0.0, 0.0});
+    for (auto& point : coordinates) {
+        if (!(inputFile >> point.first >> point.second)) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Solves the TSP using the Nearest Neighbor algorithm with a k-d tree over node coordinates.
+ * @param coordinates The (x, y) coordinates of the nodes.
+ * @param matrix A 2D matrix representing distances between nodes.
+ * @param n The number of nodes in the graph.
+ * @return A pair consisting of the route and its total duration.
+ * @note The next node is the geometrically closest unvisited one; the route is then priced with the matrix.
+ */
+pair<vector<int>, double> nearestNeighbourKdTree(const vector<pair<double, double>>& coordinates, const MatrixView& matrix, int n) {
+    KdTree tree(coordinates);
+    vector<int> route = {0}; ///< Start from the first node
+    tree.remove(0);
+    double total = 0;
+
+    for (int step = 0; step < n - 1; ++step) {
+        int current = route.back();
+        int nextLocation = tree.nearest(coordinates[current].first, coordinates[current].second);
+        tree.remove(nextLocation);
+        total += matrix[current][nextLocation];
+        route.push_back(nextLocation);
+    }
+
+    total += matrix[route.back()][0];
+    route.push_back(0); // Complete the route by returning to the start
+    return {route, total};
+}
+
+/**
+ * @brief Builds candidate lists holding the k geometrically nearest neighbours of every node.
+ * @param tree A k-d tree over the node coordinates with no points removed.
+ * @param n The number of nodes in the graph.
+ * @param k The number of neighbours to keep per node.
+ * @return The candidate list of each node, ordered from the closest neighbour.
+ */
+vector<vector<int>> buildCandidateLists(const KdTree& tree, int n, int k) {
+    vector<vector<int>> candidates(n);
+    for (int i = 0; i < n; ++i) {
+        candidates[i] = tree.kNearest(i, k);
+    }
+    return candidates;
+}
+
+/**
+ * @brief Builds candidate lists holding the k cheapest successors of every node.
+ * @param matrix A 2D matrix representing distances between nodes.
+ * @param n The number of nodes in the graph.
+ * @param k The number of successors to keep per node.
+ * @return The candidate list of each node, ordered from the cheapest arc.
+ */
+vector<vector<int>> buildCandidateLists(const MatrixView& matrix, int n, int k) {
+    k = max(0, min(k, n - 1));
+    vector<vector<int>> candidates(n);
+    vector<int> others;
+    for (int i = 0; i < n; ++i) {
+        others.clear();
+        for (int j = 0; j < n; ++j) {
+            if (j != i) others.push_back(j);
+        }
+        const double* row = matrix[i];
+        partial_sort(others.begin(), others.begin() + k, others.end(), [row](int a, int b) { return row[a] < row[b]; });
+        candidates[i].assign(others.begin(), others.begin() + k);
+    }
+    return candidates;
+}
+
+/**
+ * @brief Solves the TSP using the greedy edge (greedy matching) construction heuristic.
+ *
+ * Candidate edges from the k-d tree are added in order of increasing cost whenever they keep
+ * every node at degree two or less and close no cycle. The remaining fragments are then joined
+ * by walking to the geometrically nearest free fragment end.
+ *
+ * @param coordinates The (x, y) coordinates of the nodes.
+ * @param matrix A 2D matrix representing distances between nodes.
+ * @param n The number of nodes in the graph.
+ * @param numCandidates The number of nearest neighbours considered per node.
+ * @return A pair consisting of the route and its total duration.
+ */
+pair<vector<int>, double> greedyEdge(const vector<pair<double, double>>& coordinates, const MatrixView& matrix, int n, int numCandidates = 10) {
+    if (n < 3) return nearestNeighbourKdTree(coordinates, matrix, n);
+
+    KdTree tree(coordinates);
+    vector<vector<int>> candidates = buildCandidateLists(tree, n, numCandidates);
+
+    // Edges are undirected; asymmetric matrices are averaged over both directions
+    vector<tuple<double, int, int>> edges;
+    for (int i = 0; i < n; ++i) {
+        for (int j : candidates[i]) {
+            edges.emplace_back((matrix[i][j] + matrix[j][i]) / 2, min(i, j), max(i, j));
+        }
+    }
+    sort(edges.begin(), edges.end());
+    edges.erase(unique(edges.begin(), edges.end()), edges.end());
+
+    vector<int> fragment(n); ///< Union-find parent of each node
+    iota(fragment.begin(), fragment.end(), 0);
+    auto find = [&](int node) {
+        while (fragment[node] != node) node = fragment[node] = fragment[fragment[node]];
+        return node;
+    };
+
+    vector<vector<int>> adjacent(n);
+    int added = 0;
+    for (const auto& edge : edges) {
+        int a = get<1>(edge), b = get<2>(edge);
+        if (adjacent[a].size() < 2 && adjacent[b].size() < 2 && find(a) != find(b)) {
+            adjacent[a].push_back(b);
+            adjacent[b].push_back(a);
+            fragment[find(a)] = find(b);
+            if (++added == n - 1) break;
+        }
+    }
+
+    // Join the fragments: leave only free fragment ends in the tree
+    KdTree ends(coordinates);
+    for (int i = 0; i < n; ++i) {
+        if (adjacent[i].size() == 2) ends.remove(i);
+    }
+    auto otherEnd = [&](int start) {
+        int previous = -1, current = start;
+        while (true) {
+            int next = -1;
+            for (int neighbour : adjacent[current]) {
+                if (neighbour != previous) next = neighbour;
+            }
+            if (next == -1) return current;
+            previous = current;
+            current = next;
+        }
+    };
+
+    int first = -1;
+    for (int i = 0; i < n && first == -1; ++i) {
+        if (adjacent[i].size() < 2) first = i;
+    }
+    ends.remove(first);
+    int last = otherEnd(first);
+    if (last != first) ends.remove(last);
+    while (true) {
+        int next = ends.nearest(coordinates[last].first, coordinates[last].second);
+        if (next == -1) {
+            adjacent[last].push_back(first);
+            adjacent[first].push_back(last);
+            break;
+        }
+        ends.remove(next);
+        int nextLast = otherEnd(next);
+        if (nextLast != next) ends.remove(nextLast);
+        adjacent[last].push_back(next);
+        adjacent[next].push_back(last);
+        last = nextLast;
+    }
+
+    // Walk the cycle from the first node in the cheaper direction
+    vector<int> route = {0};
+    int previous = 0;
+    int node = adjacent[0][0];
+    while (node != 0) {
+        route.push_back(node);
+        int next = adjacent[node][0] == previous ? adjacent[node][1] : adjacent[node][0];
+        previous = node;
+        node = next;
+    }
+    route.push_back(0);
+
+    double forward = calculateTotalDuration(route, matrix);
+    reverse(route.begin(), route.end());
+    double backward = calculateTotalDuration(route, matrix);
+    if (forward < backward) {
+        reverse(route.begin(), route.end());
+        return {route, forward};
+    }
+    return {route, backward};
+}
+
+/**
+ * @brief Improves a tour with the Balas-Simonetti restricted-neighbourhood dynamic program.
+ *
+ * Finds the cheapest tour in which node i of the initial tour precedes node j whenever j >= i + k,
+ * i.e. every node moves fewer than k positions. A DP state after placing the first t + 1 positions is
+ * the window of placed nodes just above the lowest unplaced one plus the offset of the last placed
+ * node, giving O(n * k^2 * 2^k) time, linear in n for a fixed window.
+ *
+ * @param matrix A 2D matrix representing distances between nodes.
+ * @param n The number of nodes in the graph.
+ * @param initialRoute The tour to improve, e.g. from nearestNeighbour; node 0 stays first.
+ * @param k The window size (2 to 10).
+ * @return A pair consisting of the improved route and its total duration.
+ */
+pair<vector<int>, double> balasSimonetti(const MatrixView& matrix, int n, const vector<int>& initialRoute, int k = 6) {
+    // Initial order starting at node 0, without the closing return
+    vector<int> order(initialRoute.begin(), initialRoute.begin() + n);
+    rotate(order.begin(), find(order.begin(), order.end(), 0), order.end());
+    k = max(1, min(k, 10));
+    if (n <= 2 || k == 1) {
+        order.push_back(0);
+        return {order, calculateTotalDuration(order, matrix)};
+    }
+
+    const int windows = 1 << (k - 1); ///< Placed nodes among the k - 1 above the lowest unplaced one
+    const int offsets = 2 * k;        ///< Offset of the last placed node from the lowest unplaced one, plus k
+    const int states = windows * offsets;
+    vector<double> current(states, DBL_MAX), next(states, DBL_MAX);
+    vector<vector<uint16_t>> parent(n, vector<uint16_t>(states, 0)); ///< Previous state of each state per stage
+
+    // Stage 0: only node 0 is placed, the lowest unplaced node is 1
+    current[0 * offsets + (-1 + k)] = 0;
+
+    for (int t = 0; t + 1 < n; ++t) {
+        fill(next.begin(), next.end(), DBL_MAX);
+        for (int window = 0; window < windows; ++window) {
+            int low = t + 1 - static_cast<int>(bitset<16>(window).count()); ///< Lowest unplaced node
+            for (int offset = 0; offset < offsets; ++offset) {
+                double cost = current[window * offsets + offset];
+                if (cost == DBL_MAX) continue;
+                int last = low + offset - k;
+
+                for (int r = 0; r < k && low + r < n; ++r) {
+                    if (r > 0 && (window & (1 << (r - 1)))) continue;
+                    int placed = (window << 1) | (1 << r); ///< Placed bits relative to low
+                    int newLow = low;
+                    while (placed & 1) {
+                        placed >>= 1;
+                        ++newLow;
+                    }
+                    int state = (placed >> 1) * offsets + (low + r - newLow + k);
+                    double candidate = cost + matrix[order[last]][order[low + r]];
+                    if (candidate < next[state]) {
+                        next[state] = candidate;
+                        parent[t + 1][state] = static_cast<uint16_t>(window * offsets + offset);
+                    }
+                }
+            }
+        }
+        swap(current, next);
+    }
+
+    // Every node is placed: the window is empty and the lowest unplaced node is n
+    int bestState = -1;
+    double minDuration = DBL_MAX;
+    for (int offset = 0; offset < k; ++offset) {
+        double cost = current[offset];
+        if (cost == DBL_MAX) continue;
+        cost += matrix[order[n + offset - k]][order[0]];
+        if (cost < minDuration) {
+            minDuration = cost;
+            bestState = offset;
+        }
+    }
+
+    vector<int> route(n + 1, 0);
+    int state = bestState;
+    for (int t = n - 1; t >= 1; --t) {
+        int window = state / offsets, offset = state % offsets;
+        int low = t + 1 - static_cast<int>(bitset<16>(window).count());
+        route[t] = order[low + offset - k];
+        state = parent[t][state];
+    }
+    return {route, minDuration};
+}
+
+/**
+ * @brief Tour stored as an array of nodes together with the position of every node.
+ *
+ * next, prev and between take O(1). Reversing a path or moving a segment rewrites only the entries
+ * that change place, up to O(n) per move; on symmetric matrices a reversal rewrites the shorter of
+ * the path and the rest of the tour, which yields the same cycle traversed the other way round.
+ * Given a matrix, the tour keeps prefix sums of the arc costs in both directions so that the cost
+ * of traversing a path backwards is known in O(1), as 2-opt needs on asymmetric matrices.
+ */
+class ArrayTour {
+public:
+    /**
+     * @brief Creates the tour from a closed route.
+     * @param route The route, with the first node repeated at the end.
+     * @param symmetric Whether the direction of traversal may change.
+     * @param costs The matrix whose path costs reversalCost reports, or nullptr if not needed.
+     */
+    ArrayTour(const vector<int>& route, bool symmetric, const MatrixView* costs = nullptr)
+        : n(static_cast<int>(route.size()) - 1), symmetric(symmetric), costs(costs), tour(route.begin(), route.end() - 1), position(n) {
+        for (int i = 0; i < n; ++i) position[tour[i]] = i;
+        updatePrefixSums();
+    }
+
+    int next(int node) const {
+        int i = position[node] + 1;
+        return tour[i == n ? 0 : i];
+    }
+
+    int prev(int node) const {
+        int i = position[node];
+        return tour[i == 0 ? n - 1 : i - 1];
+    }
+
+    /**
+     * @brief Checks whether b lies on the path from a forward to c, ends included.
+     */
+    bool between(int a, int b, int c) const {
+        int pa = position[a], pb = position[b], pc = position[c];
+        return pa <= pc ? pa <= pb && pb <= pc : pb >= pa || pb <= pc;
+    }
+
+    /**
+     * @brief Returns the change in cost of the arcs of the path from first to last when it is
+     *        traversed backwards. Requires the matrix passed to the constructor.
+     */
+    double reversalCost(int first, int last) const {
+        return pathCost(backward, position[first], position[last]) - pathCost(forward, position[first], position[last]);
+    }
+
+    /**
+     * @brief Reverses the path from first to last.
+     */
+    void reverse(int first, int last) {
+        int length = pathLength(first, last);
+        if (symmetric && 2 * length > n) {
+            int complementFirst = next(last);
+            last = prev(first);
+            first = complementFirst;
+            length = n - length;
+        }
+        for (int i = position[first], j = position[last], k = 0; k < length / 2; ++k) {
+            int a = tour[i], b = tour[j];
+            place(i, b);
+            place(j, a);
+            i = i + 1 == n ? 0 : i + 1;
+            j = j == 0 ? n - 1 : j - 1;
+        }
+        updatePrefixSums();
+    }
+
+    /**
+     * @brief Moves the path from first to last between after and its successor.
+     * @param first The first node of the segment.
+     * @param last The last node of the segment.
+     * @param after The node the segment is placed after; must not lie on the segment.
+     * @param reversed Whether the segment is inserted from last to first.
+     */
+    void moveSegment(int first, int last, int after, bool reversed) {
+        const int length = pathLength(first, last), start = position[first];
+        segment.clear();
+        for (int node = first, k = 0; k < length; ++k, node = next(node)) segment.push_back(node);
+        if (reversed) std::reverse(segment.begin(), segment.end());
+
+        // Shift whichever part of the rest of the tour is shorter across the segment
+        const int forwardGap = pathLength(next(last), after), backwardGap = n - length - forwardGap;
+        if (forwardGap <= backwardGap) {
+            for (int k = 0; k < forwardGap; ++k) place(wrap(start + k), tour[wrap(start + length + k)]);
+            for (int k = 0; k < length; ++k) place(wrap(start + forwardGap + k), segment[k]);
+        } else {
+            for (int k = 1; k <= backwardGap; ++k) place(wrap(start + length - k), tour[wrap(start - k)]);
+            for (int k = 0; k < length; ++k) place(wrap(start - backwardGap + k), segment[k]);
+        }
+        updatePrefixSums();
+    }
+
+    /**
+     * @brief Returns the tour as a closed route starting at the given node.
+     */
+    vector<int> route(int start) const {
+        vector<int> result;
+        result.reserve(n + 1);
+        for (int node = start, k = 0; k < n; ++k, node = next(node)) result.push_back(node);
+        result.push_back(start);
+        return result;
+    }
+
+private:
+    int pathLength(int first, int last) const {
+        int distance = position[last] - position[first];
+        return (distance < 0 ? distance + n : distance) + 1;
+    }
+
+    int wrap(int index) const { return index < 0 ? index + n : index >= n ? index - n : index; }
+
+    void place(int index, int node) {
+        tour[index] = node;
+        position[node] = index;
+    }
+
+    void updatePrefixSums() {
+        if (costs == nullptr) return;
+        const MatrixView& matrix = *costs;
+        forward.resize(n + 1);
+        backward.resize(n + 1);
+        for (int p = 0; p < n; ++p) {
+            int from = tour[p], to = tour[p + 1 == n ? 0 : p + 1];
+            forward[p + 1] = forward[p] + matrix[from][to];
+            backward[p + 1] = backward[p] + matrix[to][from];
+        }
+    }
+
+    /**
+     * @brief Sums the prefix differences over the arcs between the nodes at positions first and last.
+     */
+    double pathCost(const vector<double>& prefix, int first, int last) const {
+        return first <= last ? prefix[last] - prefix[first] : prefix[n] - prefix[first] + prefix[last];
+    }
+
+    int n;
+    bool symmetric;
+    const MatrixView* costs;
+    vector<int> tour;              ///< Nodes in tour order
+    vector<int> position;          ///< Index of every node in tour
+    vector<double> forward;        ///< forward[p]: cost of the arcs from tour[0] to tour[p]
+    vector<double> backward;       ///< backward[p]: cost of the same arcs traversed backwards
+    vector<int> segment;           ///< Scratch buffer of moveSegment
+};
+
+/**
+ * @brief Tour stored as a two-level doubly-linked list (Fredman et al., 1995).
+ *
+ * The tour is cut into segments of about sqrt(n) nodes. Each segment holds its nodes in an array,
+ * a reverse bit and its rank in the circular order of segments, and every node knows its segment
+ * and index. next, prev and between take O(1). Reversing a path first splits the segments at its
+ * ends, then reverses the order of the segments in between and flips their reverse bits, and
+ * finally merges undersized segments with their neighbours, so a reversal takes O(sqrt(n))
+ * instead of the O(n) of an array. Paths are always reversed exactly, never by their complement,
+ * so the direction of the tour is kept and the structure also serves asymmetric matrices.
+ */
+class TwoLevelList {
+public:
+    /**
+     * @brief Creates the tour from a closed route.
+     * @param route The route, with the first node repeated at the end.
+     * @param costs The matrix whose path costs reversalCost reports, or nullptr if not needed.
+     */
+    explicit TwoLevelList(const vector<int>& route, const MatrixView* costs = nullptr)
+        : n(static_cast<int>(route.size()) - 1), groupSize(max(8, static_cast<int>(sqrt(static_cast<double>(n))))),
+          costs(costs), segmentOf(n), indexOf(n) {
+        build(vector<int>(route.begin(), route.end() - 1));
+    }
+
+    int next(int node) const {
+        const Segment& segment = segments[segmentOf[node]];
+        int i = indexOf[node];
+        if (!segment.reversed) {
+            if (i + 1 < static_cast<int>(segment.nodes.size())) return segment.nodes[i + 1];
+        } else if (i > 0) {
+            return segment.nodes[i - 1];
+        }
+        return head(order[segment.rank + 1 == static_cast<int>(order.size()) ? 0 : segment.rank + 1]);
+    }
+
+    int prev(int node) const {
+        const Segment& segment = segments[segmentOf[node]];
+        int i = indexOf[node];
+        if (!segment.reversed) {
+            if (i > 0) return segment.nodes[i - 1];
+        } else if (i + 1 < static_cast<int>(segment.nodes.size())) {
+            return segment.nodes[i + 1];
+        }
+        return tail(order[segment.rank == 0 ? static_cast<int>(order.size()) - 1 : segment.rank - 1]);
+    }
+
+    /**
+     * @brief Checks whether b lies on the path from a forward to c, ends included.
+     */
+    bool between(int a, int b, int c) const {
+        auto pa = key(a), pb = key(b), pc = key(c);
+        return pa <= pc ? pa <= pb && pb <= pc : pb >= pa || pb <= pc;
+    }
+
+    /**
+     * @brief Returns the change in cost of the arcs of the path from first to last when it is
+     *        traversed backwards. Requires the matrix passed to the constructor and takes time
+     *        linear in the length of the path.
+     */
+    double reversalCost(int first, int last) const {
+        const MatrixView& matrix = *costs;
+        double delta = 0.0;
+        for (int node = first; node != last; node = next(node)) {
+            int successor = next(node);
+            delta += matrix[successor][node] - matrix[node][successor];
+        }
+        return delta;
+    }
+
+    /**
+     * @brief Reverses the path from first to last.
+     */
+    void reverse(int first, int last) {
+        if (first == last) return;
+        splitBefore(first);
+        splitBefore(next(last));
+
+        // The path now consists of whole segments; reverse their order and flip each of them
+        const int k = static_cast<int>(order.size());
+        int i = segments[segmentOf[first]].rank, j = segments[segmentOf[last]].rank;
+        const int count = (j - i + k) % k + 1;
+        for (int step = 0; step < count; ++step) segments[order[(i + step) % k]].reversed ^= true;
+        for (int step = 0; step < count / 2; ++step) {
+            swap(order[i], order[j]);
+            segments[order[i]].rank = i;
+            segments[order[j]].rank = j;
+            i = i + 1 == k ? 0 : i + 1;
+            j = j == 0 ? k - 1 : j - 1;
+        }
+
+        for (int node : {first, last}) {
+            mergeSmall(segmentOf[node]);
+            mergeSmall(segmentOf[node]);
+        }
+        if (static_cast<int>(order.size()) > 4 * (n / groupSize + 1)) build(route(head(order[0])));
+    }
+
+    /**
+     * @brief Moves the path from first to last between after and its successor.
+     * @param first The first node of the segment.
+     * @param last The last node of the segment.
+     * @param after The node the segment is placed after; must not lie on the segment.
+     * @param reversed Whether the segment is inserted from last to first.
+     */
+    void moveSegment(int first, int last, int after, bool reversed) {
+        if (after == prev(first)) {
+            if (reversed) reverse(first, last);
+            return;
+        }
+
+        // p first..last q..after y becomes p q..after first..last y with three reversals
+        int q = next(last);
+        reverse(first, after);
+        reverse(after, q);
+        if (!reversed) reverse(last, first);
+    }
+
+    /**
+     * @brief Returns the tour as a closed route starting at the given node.
+     */
+    vector<int> route(int start) const {
+        vector<int> result;
+        result.reserve(n + 1);
+        for (int node = start, k = 0; k < n; ++k, node = next(node)) result.push_back(node);
+        result.push_back(start);
+        return result;
+    }
+
+private:
+    struct Segment {
+        vector<int> nodes;     ///< Nodes in stored order
+        bool reversed = false; ///< Whether the tour traverses nodes from back to front
+        int rank = 0;          ///< Position in order
+    };
+
+    int head(int s) const { return segments[s].reversed ? segments[s].nodes.back() : segments[s].nodes.front(); }
+    int tail(int s) const { return segments[s].reversed ? segments[s].nodes.front() : segments[s].nodes.back(); }
+
+    /**
+     * @brief Returns the index of a node along the tour within its segment.
+     */
+    int offset(int node) const {
+        const Segment& segment = segments[segmentOf[node]];
+        return segment.reversed ? static_cast<int>(segment.nodes.size()) - 1 - indexOf[node] : indexOf[node];
+    }
+
+    pair<int, int> key(int node) const { return {segments[segmentOf[node]].rank, offset(node)}; }
+
+    /**
+     * @brief Splits the tour into segments of groupSize nodes.
+     */
+    void build(const vector<int>& nodes) {
+        segments.clear();
+        order.clear();
+        freeSegments.clear();
+        for (int start = 0; start < n; start += groupSize) {
+            int s = static_cast<int>(segments.size());
+            segments.emplace_back();
+            segments[s].nodes.assign(nodes.begin() + start, nodes.begin() + min(n, start + groupSize));
+            segments[s].rank = s;
+            order.push_back(s);
+            reindex(s);
+        }
+    }
+
+    void reindex(int s) {
+        const vector<int>& nodes = segments[s].nodes;
+        for (int i = 0; i < static_cast<int>(nodes.size()); ++i) {
+            segmentOf[nodes[i]] = s;
+            indexOf[nodes[i]] = i;
+        }
+    }
+
+    int newSegment() {
+        if (!freeSegments.empty()) {
+            int s = freeSegments.back();
+            freeSegments.pop_back();
+            segments[s] = Segment();
+            return s;
+        }
+        segments.emplace_back();
+        return static_cast<int>(segments.size()) - 1;
+    }
+
+    /**
+     * @brief Inserts or removes a segment at a rank and renumbers the ranks after it.
+     */
+    void insertAt(int rank, int s) {
+        order.insert(order.begin() + rank, s);
+        for (int r = rank; r < static_cast<int>(order.size()); ++r) segments[order[r]].rank = r;
+    }
+
+    void eraseAt(int rank) {
+        freeSegments.push_back(order[rank]);
+        order.erase(order.begin() + rank);
+        for (int r = rank; r < static_cast<int>(order.size()); ++r) segments[order[r]].rank = r;
+    }
+
+    /**
+     * @brief Makes node the first node of its segment by moving the smaller part of the segment into a new one.
+     */
+    void splitBefore(int node) {
+        const int s = segmentOf[node], cut = offset(node);
+        if (cut == 0) return;
+        const int size = static_cast<int>(segments[s].nodes.size());
+        const bool front = cut <= size - cut; ///< Whether the part before node moves out
+
+        // The moving part in tour order, as a new unreversed segment
+        const int t = newSegment();
+        Segment& segment = segments[s];
+        Segment& part = segments[t];
+        int lo = front ? 0 : cut, hi = front ? cut : size;
+        for (int p = lo; p < hi; ++p) part.nodes.push_back(segment.nodes[segment.reversed ? size - 1 - p : p]);
+        if (segment.reversed) segment.nodes.erase(segment.nodes.begin() + (size - hi), segment.nodes.begin() + (size - lo));
+        else segment.nodes.erase(segment.nodes.begin() + lo, segment.nodes.begin() + hi);
+
+        reindex(s);
+        reindex(t);
+        insertAt(front ? segment.rank : segment.rank + 1, t);
+    }
+
+    /**
+     * @brief Merges a segment into its successor or predecessor if both together fit in a group.
+     */
+    void mergeSmall(int s) {
+        if (order.size() < 2) return;
+        const int k = static_cast<int>(order.size());
+        const int following = order[(segments[s].rank + 1) % k], preceding = order[(segments[s].rank + k - 1) % k];
+        const int size = static_cast<int>(segments[s].nodes.size());
+        if (size + static_cast<int>(segments[following].nodes.size()) <= groupSize) {
+            merge(s, following);
+        } else if (size + static_cast<int>(segments[preceding].nodes.size()) <= groupSize) {
+            merge(preceding, s);
+        }
+    }
+
+    /**
+     * @brief Appends segment t, which follows segment s, to s.
+     */
+    void merge(int s, int t) {
+        Segment& target = segments[s];
+        Segment& source = segments[t];
+        if (target.reversed) {
+            std::reverse(target.nodes.begin(), target.nodes.end());
+            target.reversed = false;
+        }
+        if (source.reversed) target.nodes.insert(target.nodes.end(), source.nodes.rbegin(), source.nodes.rend());
+        else target.nodes.insert(target.nodes.end(), source.nodes.begin(), source.nodes.end());
+        source.nodes.clear();
+        reindex(s);
+        eraseAt(source.rank);
+    }
+
+    int n;
+    int groupSize;              ///< Target number of nodes per segment
+    const MatrixView* costs;
+    vector<Segment> segments;
+    vector<int> order;          ///< Segments in tour order
+    vector<int> freeSegments;   ///< Unused entries of segments
+    vector<int> segmentOf;      ///< Segment of every node
+    vector<int> indexOf;        ///< Index of every node in its segment's nodes
+};
+
+const int TWO_LEVEL_MIN_NODES = 10000; ///< Tours from this size on are searched on a TwoLevelList
+
+/**
+ * @brief Runs 2-opt moves restricted to candidate lists on a tour, using don't-look bits.
+ *
+ * A move replaces the arcs (a, b) and (c, d), where b follows a and d follows c, by (a, c) and
+ * (b, d) and reverses the path from b to c. Only the candidates c of a with d(a, c) < d(a, b) are
+ * tried. A node's don't-look bit is set when no improving move starts from it and cleared when one
+ * of its tour neighbours changes, so later passes only revisit the parts of the tour that moved.
+ *
+ * On asymmetric matrices the reversed path changes cost as well; it is taken from the tour's
+ * reversalCost. Moves that give a a new predecessor c also draw c from a's list of cheapest
+ * successors, which is scanned in full in that case.
+ *
+ * @param matrix A 2D matrix representing distances between nodes.
+ * @param candidates The candidate lists from buildCandidateLists, ordered from the cheapest arc.
+ * @param symmetric Whether the matrix is symmetric.
+ * @param initialRoute The closed route the tour was built from; sets the order of the first pass.
+ * @param tour The tour to improve, an ArrayTour or a TwoLevelList; built with the matrix on asymmetric matrices.
+ */
+template <typename Tour>
+void twoOptSearch(const MatrixView& matrix, const vector<vector<int>>& candidates, bool symmetric, const vector<int>& initialRoute, Tour& tour) {
+    vector<char> queued(initialRoute.size() - 1, 1); ///< Nodes whose don't-look bit is clear
+    vector<int> stack(initialRoute.rbegin() + 1, initialRoute.rend());
+    while (!stack.empty()) {
+        int a = stack.back();
+        stack.pop_back();
+        queued[a] = 0;
+
+        bool improved = false;
+        for (int direction = 0; direction < 2 && !improved; ++direction) {
+            // direction 0: a -> b ... c -> d becomes a -> c ... b -> d;
+            // direction 1: d -> c ... b -> a becomes d -> b ... c -> a
+            int b = direction == 0 ? tour.next(a) : tour.prev(a);
+            double removed = direction == 0 ? matrix[a][b] : matrix[b][a];
+            for (int c : candidates[a]) {
+                double added = direction == 0 ? matrix[a][c] : matrix[c][a];
+                if (added >= removed) {
+                    if (direction == 0 || symmetric) break;
+                    continue;
+                }
+                int d = direction == 0 ? tour.next(c) : tour.prev(c);
+                if (c == b || d == a) continue;
+
+                double delta;
+                if (direction == 0) {
+                    delta = matrix[a][c] + matrix[b][d] - matrix[a][b] - matrix[c][d];
+                    if (!symmetric) delta += tour.reversalCost(b, c);
+                } else {
+                    delta = matrix[c][a] + matrix[d][b] - matrix[b][a] - matrix[d][c];
+                    if (!symmetric) delta += tour.reversalCost(c, b);
+                }
+                if (delta >= -1e-9) continue;
+
+                if (direction == 0) tour.reverse(b, c);
+                else tour.reverse(c, b);
+                for (int node : {a, b, c, d}) {
+                    if (!queued[node]) {
+                        queued[node] = 1;
+                        stack.push_back(node);
+                    }
+                }
+                improved = true;
+                break;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Improves a tour with 2-opt moves restricted to candidate lists, using don't-look bits.
+ *
+ * See twoOptSearch for the neighbourhood. Symmetric tours of at least TWO_LEVEL_MIN_NODES nodes are
+ * held in a TwoLevelList, where a reversal takes O(sqrt(n)); others in an ArrayTour, whose O(n)
+ * reversals are faster on small tours and whose prefix sums price reversed paths in O(1).
+ *
+ * @param matrix A 2D matrix representing distances between nodes.
+ * @param n The number of nodes in the graph.
+ * @param initialRoute The closed tour to improve; its first node stays first.
+ * @param candidates The candidate lists from buildCandidateLists, ordered from the cheapest arc.
+ * @param symmetric Whether the matrix is symmetric.
+ * @return A pair consisting of the improved route and its total duration.
+ */
+pair<vector<int>, double> twoOpt(const MatrixView& matrix, int n, const vector<int>& initialRoute, const vector<vector<int>>& candidates, bool symmetric) {
+    if (n < 4) return {initialRoute, calculateTotalDuration(initialRoute, matrix)};
+
+    vector<int> route;
+    if (symmetric && n >= TWO_LEVEL_MIN_NODES) {
+        TwoLevelList tour(initialRoute);
+        twoOptSearch(matrix, candidates, symmetric, initialRoute, tour);
+        route = tour.route(initialRoute[0]);
+    } else {
+        ArrayTour tour(initialRoute, symmetric, symmetric ? nullptr : &matrix);
+        twoOptSearch(matrix, candidates, symmetric, initialRoute, tour);
+        route = tour.route(initialRoute[0]);
+    }
+    return {route, calculateTotalDuration(route, matrix)};
+}
+
+/**
+ * @brief Runs Or-opt moves restricted to candidate lists on a tour, using don't-look bits.
+ *
+ * A move takes a segment of 1 to 3 nodes out of the tour and inserts it, in either direction,
+ * between two consecutive nodes x and y elsewhere; it is the segment-insertion subset of 3-opt.
+ * The segments tried start or end at a node a, and x or y is one of a's candidates so that a gains
+ * a cheap arc. Every move is evaluated with O(1) lookups on the tour.
+ *
+ * Unlike 2-opt, a segment inserted in its own direction keeps its internal arcs, so the
+ * neighbourhood stays exact on asymmetric matrices; for a reversed insertion the cost of the at
+ * most two internal arcs traversed backwards is added.
+ *
+ * @param matrix A 2D matrix representing distances between nodes.
+ * @param candidates The candidate lists from buildCandidateLists, ordered from the cheapest arc.
+ * @param symmetric Whether the matrix is symmetric.
+ * @param initialRoute The closed route the tour was built from; sets the order of the first pass.
+ * @param tour The tour to improve: an ArrayTour or a TwoLevelList.
+ */
+template <typename Tour>
+void orOptSearch(const MatrixView& matrix, const vector<vector<int>>& candidates, bool symmetric, const vector<int>& initialRoute, Tour& tour) {
+    vector<char> queued(initialRoute.size() - 1, 1); ///< Nodes whose don't-look bit is clear
+    vector<int> stack(initialRoute.rbegin() + 1, initialRoute.rend());
+    while (!stack.empty()) {
+        int a = stack.back();
+        stack.pop_back();
+        queued[a] = 0;
+
+        bool improved = false;
+        for (int length = 1; length <= 3 && !improved; ++length) {
+            for (int end = 0; end < (length == 1 ? 1 : 2) && !improved; ++end) {
+                // end 0: the segment starts at a; end 1: it ends at a
+                int first = a, last = a;
+                for (int k = 1; k < length; ++k) {
+                    if (end == 0) last = tour.next(last);
+                    else first = tour.prev(first);
+                }
+                const int p = tour.prev(first), q = tour.next(last);
+                const double removalGain = matrix[p][first] + matrix[last][q] - matrix[p][q];
+                double reversalCost = 0.0; ///< Change in the internal arcs when the segment is reversed
+                for (int node = first; node != last; node = tour.next(node)) {
+                    reversalCost += matrix[tour.next(node)][node] - matrix[node][tour.next(node)];
+                }
+
+                for (int c : candidates[a]) {
+                    if (symmetric && matrix[a][c] >= removalGain) break;
+                    for (int reversed = 0; reversed < 2; ++reversed) {
+                        // Place a next to c: after c if a leads the inserted segment, before c otherwise
+                        bool aLeads = (a == first) != (reversed == 1);
+                        int x = aLeads ? c : tour.prev(c), y = aLeads ? tour.next(c) : c;
+                        if (tour.between(first, x, last) || tour.between(first, y, last)) continue;
+
+                        double delta = reversed ? matrix[x][last] + matrix[first][y] + reversalCost : matrix[x][first] + matrix[last][y];
+                        delta -= removalGain + matrix[x][y];
+                        if (delta >= -1e-9) continue;
+
+                        tour.moveSegment(first, last, x, reversed == 1);
+                        for (int node : {a, first, last, p, q, x, y}) {
+                            if (!queued[node]) {
+                                queued[node] = 1;
+                                stack.push_back(node);
+                            }
+                        }
+                        improved = true;
+                        break;
+                    }
+                    if (improved) break;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Improves a tour with Or-opt moves restricted to candidate lists, using don't-look bits.
+ *
+ * See orOptSearch for the neighbourhood. Tours of at least TWO_LEVEL_MIN_NODES nodes are held in a
+ * TwoLevelList, where moving a segment takes O(sqrt(n)); others in an ArrayTour.
+ *
+ * @param matrix A 2D matrix representing distances between nodes.
+ * @param n The number of nodes in the graph.
+ * @param initialRoute The closed tour to improve; its first node stays first.
+ * @param candidates The candidate lists from buildCandidateLists, ordered from the cheapest arc.
+ * @param symmetric Whether the matrix is symmetric.
+ * @return A pair consisting of the improved route and its total duration.
+ */
+pair<vector<int>, double> orOpt(const MatrixView& matrix, int n, const vector<int>& initialRoute, const vector<vector<int>>& candidates, bool symmetric) {
+    if (n < 5) return {initialRoute, calculateTotalDuration(initialRoute, matrix)};
+
+    vector<int> route;
+    if (n >= TWO_LEVEL_MIN_NODES) {
+        TwoLevelList tour(initialRoute);
+        orOptSearch(matrix, candidates, symmetric, initialRoute, tour);
+        route = tour.route(initialRoute[0]);
+    } else {
+        ArrayTour tour(initialRoute, symmetric);
+        orOptSearch(matrix, candidates, symmetric, initialRoute, tour);
+        route = tour.route(initialRoute[0]);
+    }
+    return {route, calculateTotalDuration(route, matrix)};
+}
+
+/**
+ * @brief Brute force for a compile-time number of nodes with a stack-resident route.
+ *
+ * Permutations are enumerated in the same lexicographic order as bruteForce, but the cost of the
+ * route prefix up to every position is kept, so only the suffix that the permutation step
+ * rearranged is summed again. The costs are added in the same order as calculateTotalDuration,
+ * so the result is identical to bruteForce.
+ *
+ * @tparam N The number of nodes in the graph (at least 3).
+ * @param matrix A 2D matrix representing distances between nodes.
+ * @return A pair consisting of the optimal route and its total duration.
+ */
+template <int N>
+pair<vector<int>, double> bruteForceSmall(const MatrixView& matrix) {
+    static_assert(N >= 3, "smaller instances have a single route");
+    array<array<double, N>, N> cost;
+    for (int i = 0; i < N; ++i) {
+        for (int j = 0; j < N; ++j) cost[i][j] = matrix[i][j];
+    }
+
+    array<int, N + 1> route;      ///< Positions 1..N-1 are permuted, both ends are node 0
+    array<double, N + 1> prefix;  ///< prefix[p] is the cost of the route up to position p
+    for (int p = 0; p < N; ++p) route[p] = p;
+    route[N] = 0;
+    prefix[0] = 0;
+    int changed = 1;              ///< First position whose prefix cost is out of date
+
+    array<int, N + 1> optimalRoute = route;
+    double minDuration = DBL_MAX;
+    while (true) {
+        for (int p = changed; p <= N; ++p) prefix[p] = prefix[p - 1] + cost[route[p - 1]][route[p]];
+        if (prefix[N] < minDuration) {
+            minDuration = prefix[N];
+            optimalRoute = route;
+        }
+
+        // Next permutation of positions 1..N-1 (as next_permutation), remembering where it starts
+        int i = N - 2;
+        while (i >= 1 && route[i] > route[i + 1]) --i;
+        if (i < 1) break;
+        int j = N - 1;
+        while (route[j] < route[i]) --j;
+        swap(route[i], route[j]);
+        reverse(route.begin() + i + 1, route.begin() + N);
+        changed = i;
+    }
+    return {vector<int>(optimalRoute.begin(), optimalRoute.end()), minDuration};
+}
+
+/**
+ * @brief Held-Karp for a compile-time number of nodes with a fully stack-resident DP table.
+ *
+ * For the small routes that make up most of our instances the generic solver is dominated by
+ * allocation; here the table is a std::array indexed by 16-bit masks and every loop bound is a
+ * constant, so nothing touches the heap until the route is returned.
+ *
+ * @tparam N The number of nodes in the graph (3 to 16).
+ * @param matrix A 2D matrix representing distances between nodes.
+ * @return A pair consisting of the optimal route and its total duration.
+ */
+template <int N>
+pair<vector<int>, double> heldKarpSmall(const MatrixView& matrix) {
+    static_assert(N >= 3 && N <= 16, "masks over the nodes besides the start must fit in 16 bits");
+    constexpr int M = N - 1;             ///< Nodes besides the starting node; node v is bit v - 1
+    constexpr int SUBSETS = 1 << M;
+
+    array<array<double, M>, M> cost;     ///< cost[j][i] = matrix[j + 1][i + 1], infinite on the diagonal
+    for (int j = 0; j < M; ++j) {
+        for (int i = 0; i < M; ++i) cost[j][i] = (i == j) ? HUGE_VAL : matrix[j + 1][i + 1];
+    }
+
+    // Entries whose end node is outside the mask stay infinite, so the inner loop needs no branch
+    array<array<double, M>, SUBSETS> dp;
+    for (auto& row : dp) row.fill(HUGE_VAL);
+    for (int i = 0; i < M; ++i) {
+        dp[1 << i][i] = matrix[0][i + 1];
+    }
+
+    for (int mask = 3; mask < SUBSETS; ++mask) {
+        if ((mask & (mask - 1)) == 0) continue;
+        for (int i = 0; i < M; ++i) {
+            if (!(mask & (1 << i))) continue;
+            uint16_t previous = static_cast<uint16_t>(mask ^ (1 << i));
+            double best = HUGE_VAL;
+            for (int j = 0; j < M; ++j) {
+                best = min(best, dp[previous][j] + cost[j][i]);
+            }
+            dp[mask][i] = best;
+        }
+    }
+
+    uint16_t mask = static_cast<uint16_t>(SUBSETS - 1);
+    int last = 0;
+    double minDuration = DBL_MAX;
+    for (int i = 0; i < M; ++i) {
+        if (dp[mask][i] + matrix[i + 1][0] < minDuration) {
+            minDuration = dp[mask][i] + matrix[i + 1][0];
+            last = i;
+        }
+    }
+
+    // Backtrack by finding the predecessor that attains each entry on the optimal path
+    array<int, N + 1> path;
+    path[N] = 0;
+    for (int position = M; position >= 1; --position) {
+        path[position] = last + 1;
+        mask = static_cast<uint16_t>(mask ^ (1 << last));
+        int from = -1;
+        double best = DBL_MAX;
+        for (int j = 0; j < M && mask; ++j) {
+            if ((mask & (1 << j)) && dp[mask][j] + cost[j][last] < best) {
+                best = dp[mask][j] + cost[j][last];
+                from = j;
+            }
+        }
+        last = from;
+    }
+    path[0] = 0;
+    return {vector<int>(path.begin(), path.end()), minDuration};
+}
+
+using ExactSolver = pair<vector<int>, double> (*)(const MatrixView&); ///< Exact solver for a fixed size
+
+const int SMALL_EXACT_MAX = 12; ///< Largest instance handled by the stack-resident solvers
+
+/**
+ * @brief Stack-resident exact solvers for one instance size.
+ */
+struct SmallExactSolvers {
+    ExactSolver bruteForce;
+    ExactSolver heldKarp;
+};
+
+/**
+ * @brief Dispatch table of the stack-resident exact solvers, indexed by the number of nodes.
+ */
+const SmallExactSolvers SMALL_EXACT_SOLVERS[SMALL_EXACT_MAX + 1] = {
+    {nullptr, nullptr}, {nullptr, nullptr}, {nullptr, nullptr},
+    {&bruteForceSmall<3>, &heldKarpSmall<3>},   {&bruteForceSmall<4>, &heldKarpSmall<4>},
+    {&bruteForceSmall<5>, &heldKarpSmall<5>},   {&bruteForceSmall<6>, &heldKarpSmall<6>},
+    {&bruteForceSmall<7>, &heldKarpSmall<7>},   {&bruteForceSmall<8>, &heldKarpSmall<8>},
+    {&bruteForceSmall<9>, &heldKarpSmall<9>},   {&bruteForceSmall<10>, &heldKarpSmall<10>},
+    {&bruteForceSmall<11>, &heldKarpSmall<11>}, {&bruteForceSmall<12>, &heldKarpSmall<12>},
+};
+
+/**
+ * @brief Solves the TSP using a brute force approach.
+ *
+ * Instances of up to SMALL_EXACT_MAX nodes are dispatched to the stack-resident bruteForceSmall.
+ *
+ * @param matrix A 2D matrix representing distances between nodes.
+ * @param n The number of nodes in the graph.
+ * @return A pair consisting of the optimal route and its total duration.
+ */
+pair<vector<int>, double> bruteForce(const MatrixView& matrix, int n) {
+    if (n <= SMALL_EXACT_MAX && SMALL_EXACT_SOLVERS[n].bruteForce != nullptr) {
+        return SMALL_EXACT_SOLVERS[n].bruteForce(matrix);
+    }
+    vector<int> locations(n - 1);
+    iota(locations.begin(), locations.end(), 1); // Generate {1, 2, ..., n-1}
+
+    double minDuration = DBL_MAX;
+    vector<int> optimalRoute;
+
+    do {
+        vector<int> route = {0}; // Start at the first node
+        route.insert(route.end(), locations.begin(), locations.end());
+        route.push_back(0); // Return to the start
+
+        double duration = calculateTotalDuration(route, matrix);
+        if (duration < minDuration) {
+            minDuration = duration;
+            optimalRoute = route;
+        }
+    } while (next_permutation(locations.begin(), locations.end())); // Try all permutations
+
+    return {optimalRoute, minDuration};
+}
+
+/**
+ * @brief Solves the TSP by brute force, enumerating permutations with Heap's algorithm.
+ *
+ * Consecutive permutations differ by a single swap, so the tour cost is updated in O(1) from the
+ * at most four edges around the swapped positions instead of being recomputed for every
+ * permutation. The running cost is resynchronised periodically to stop rounding drift.
+ *
+ * @param matrix A 2D matrix representing distances between nodes.
+ * @param n The number of nodes in the graph.
+ * @return A pair consisting of the optimal route and its total duration.
+ */
+pair<vector<int>, double> bruteForceHeap(const MatrixView& matrix, int n) {
+    if (n <= 2) return bruteForce(matrix, n);
+
+    vector<int> route(n + 1); ///< Current tour, starting and ending at node 0
+    iota(route.begin(), route.end() - 1, 0);
+    route[n] = 0;
+    auto edge = [&](int e) { return matrix[route[e]][route[e + 1]]; };
+
+    double duration = 0;
+    for (int e = 0; e < n; ++e) duration += edge(e);
+    double minDuration = duration;
+    vector<int> optimalRoute = route;
+
+    int m = n - 1;           ///< Permuted positions are 1..m
+    vector<int> counter(m, 0); ///< Heap's algorithm loop counters
+    long long steps = 0;
+    int i = 1;
+    while (i < m) {
+        if (counter[i] < i) {
+            int a = (i % 2 == 0) ? 1 : counter[i] + 1;
+            int b = i + 1;
+
+            // Edges e = (route[e], route[e + 1]) touching positions a < b; adjacent positions share one
+            int edges[4] = {a - 1, a, b - 1, b};
+            int count = (b == a + 1) ? 3 : 4;
+            if (b == a + 1) edges[2] = b;
+            for (int k = 0; k < count; ++k) duration -= edge(edges[k]);
+            swap(route[a], route[b]);
+            for (int k = 0; k < count; ++k) duration += edge(edges[k]);
+
+            if ((++steps & 4095) == 0) {
+                duration = 0;
+                for (int e = 0; e < n; ++e) duration += edge(e);
+            }
+            if (duration < minDuration) {
+                minDuration = duration;
+                optimalRoute = route;
+            }
+            ++counter[i];
+            i = 1;
+        } else {
+            counter[i] = 0;
+            ++i;
+        }
+    }
+
+    return {optimalRoute, calculateTotalDuration(optimalRoute, matrix)};
+}
+
+/**
+ * @brief Counter-based random number generator Philox4x32-10 (Salmon et al., 2011).
+ *
+ * The output is a fixed function of the key (the seed) and a 128-bit counter, so independent
+ * streams are obtained by fixing the upper half of the counter, e.g. to (iteration, ant), without
+ * any state shared between threads. Satisfies the UniformRandomBitGenerator requirements.
+ */
+class Philox4x32 {
+public:
+    using result_type = uint32_t;
+
+    /**
+     * @brief Creates the generator for one stream.
+     * @param seed The key shared by all streams of a run.
+     * @param stream0 The first half of the stream identifier.
+     * @param stream1 The second half of the stream identifier.
+     */
+    Philox4x32(uint64_t seed, uint32_t stream0 = 0, uint32_t stream1 = 0)
+        : counter{0, 0, stream0, stream1}, key{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)} {}
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return UINT32_MAX; }
+
+    result_type operator()() {
+        if (index == 4) {
+            generate();
+            index = 0;
+        }
+        return output[index++];
+    }
+
+private:
+    void generate() {
+        array<uint32_t, 4> block = counter;
+        array<uint32_t, 2> roundKey = key;
+        for (int round = 0; round < 10; ++round) {
+            uint64_t product0 = static_cast<uint64_t>(0xD2511F53u) * block[0];
+            uint64_t product1 = static_cast<uint64_t>(0xCD9E8D57u) * block[2];
+            block = {static_cast<uint32_t>(product1 >> 32) ^ block[1] ^ roundKey[0], static_cast<uint32_t>(product1),
+                     static_cast<uint32_t>(product0 >> 32) ^ block[3] ^ roundKey[1], static_cast<uint32_t>(product0)};
+            roundKey[0] += 0x9E3779B9u;
+            roundKey[1] += 0xBB67AE85u;
+        }
+        output = block;
+        if (++counter[0] == 0) ++counter[1];
+    }
+
+    array<uint32_t, 4> counter; ///< Block counter in the lower half, stream identifier in the upper half
+    array<uint32_t, 2> key;
+    array<uint32_t, 4> output{};
+    int index = 4;              ///< Next unused word of output
+};
+
+/**
+ * @brief Computes the heuristic desirability (1 / d)^beta of every arc.
+ * @param matrix A 2D matrix representing distances between nodes.
+ * @param n The number of nodes in the graph.
+ * @param beta The importance of distance in decision-making.
+ * @return The n x n desirabilities in row-major order.
+ */
+vector<double> heuristicInformation(const MatrixView& matrix, int n, double beta) {
+    vector<double> eta(static_cast<size_t>(n) * n);
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+            eta[static_cast<size_t>(i) * n + j] = pow(1.0 / max(matrix[i][j], 1e-6), beta);
+        }
+    }
+    return eta;
+}
+
+/**
+ * @brief Alias tables (Walker's method, built with Vose's algorithm) over the successors of every node.
+ *
+ * Each node gets a table over its candidate list, or over all other nodes, weighted by the choice
+ * table. Drawing a successor then takes one random number and two lookups regardless of the
+ * number of candidates. Building the tables is linear in their total size, so they are rebuilt
+ * once per iteration after the pheromone update.
+ */
+class AliasSampler {
+public:
+    /**
+     * @brief Builds the tables from the current choice weights.
+     * @param choiceInfo The n x n weights tau^alpha * eta^beta in row-major order.
+     * @param candidates The candidate successors of every node, or an empty list to use all nodes.
+     * @param n The number of nodes in the graph.
+     */
+    void build(const vector<double>& choiceInfo, const vector<vector<int>>& candidates, int n) {
+        width = candidates.empty() ? n - 1 : static_cast<int>(candidates[0].size());
+        size_t size = static_cast<size_t>(n) * width;
+        outcome.resize(size);
+        alias.resize(size);
+        threshold.resize(size);
+
+        vector<double> scaled(width);
+        vector<int> small, large;
+        for (int i = 0; i < n; ++i) {
+            int* nodes = outcome.data() + static_cast<size_t>(i) * width;
+            if (candidates.empty()) {
+                for (int j = 0, s = 0; j < n; ++j) {
+                    if (j != i) nodes[s++] = j;
+                }
+            } else {
+                copy(candidates[i].begin(), candidates[i].end(), nodes);
+            }
+
+            const double* row = choiceInfo.data() + static_cast<size_t>(i) * n;
+            double total = 0.0;
+            for (int s = 0; s < width; ++s) total += row[nodes[s]];
+
+            // Split the slots into those below and above the average weight and pair them up
+            small.clear();
+            large.clear();
+            for (int s = 0; s < width; ++s) {
+                scaled[s] = total > 0 ? row[nodes[s]] * width / total : 1.0;
+                (scaled[s] < 1.0 ? small : large).push_back(s);
+            }
+            double* rowThreshold = threshold.data() + static_cast<size_t>(i) * width;
+            int* rowAlias = alias.data() + static_cast<size_t>(i) * width;
+            while (!small.empty() && !large.empty()) {
+                int less = small.back(), more = large.back();
+                small.pop_back();
+                rowThreshold[less] = scaled[less];
+                rowAlias[less] = more;
+                scaled[more] -= 1.0 - scaled[less];
+                if (scaled[more] < 1.0) {
+                    large.pop_back();
+                    small.push_back(more);
+                }
+            }
+            // Whatever is left is 1 up to rounding
+            for (int s : small) rowThreshold[s] = 1.0, rowAlias[s] = s;
+            for (int s : large) rowThreshold[s] = 1.0, rowAlias[s] = s;
+        }
+    }
+
+    /**
+     * @brief Draws a successor of a node with probability proportional to its weight.
+     * @param node The current node.
+     * @param gen The random number generator.
+     * @return The successor drawn, which may already have been visited.
+     */
+    template <typename Generator>
+    int sample(int node, Generator& gen) const {
+        double u = uniform_real_distribution<double>(0.0, width)(gen);
+        int slot = min(static_cast<int>(u), width - 1);
+        size_t offset = static_cast<size_t>(node) * width;
+        return outcome[offset + (u - slot < threshold[offset + slot] ? slot : alias[offset + slot])];
+    }
+
+    bool empty() const { return outcome.empty(); }
+
+private:
+    int width = 0;             ///< Entries per node
+    vector<int> outcome;       ///< Successor held by each slot
+    vector<int> alias;         ///< Slot taken when the draw exceeds the threshold
+    vector<double> threshold;  ///< Probability of keeping the slot's own successor
+};
+
+const int ALIAS_ATTEMPTS = 8; ///< Draws from the alias table before falling back to the roulette
+
+/**
+ * @brief Builds one ant's tour by roulette-wheel selection.
+ *
+ * The next node is drawn among the unvisited entries of the current node's candidate list with
+ * probability proportional to tau^alpha * eta^beta, read from a precomputed table instead of
+ * calling pow for every candidate. When every candidate has been visited, the unvisited node with
+ * the largest weight is taken. Without candidate lists the roulette runs over all unvisited nodes.
+ * With the pseudo-random proportional rule of Ant Colony System, the candidate with the largest
+ * weight is taken with probability q0 and the roulette is only run otherwise.
+ *
+ * With alias tables the roulette is replaced by drawing from the current node's table until an
+ * unvisited node comes up. After ALIAS_ATTEMPTS failed draws the roulette runs as usual; since the
+ * draws are independent of which unvisited node would be chosen, the distribution is unchanged.
+ *
+ * @param choiceInfo The n x n weights tau^alpha * eta^beta in row-major order.
+ * @param candidates The candidate successors of every node, or an empty list to use all nodes.
+ * @param n The number of nodes in the graph.
+ * @param start The node the tour starts from.
+ * @param gen The random number generator.
+ * @param route Receives the n + 1 nodes of the tour, ending back at start.
+ * @param q0 The probability of taking the best candidate instead of sampling.
+ * @param sampler Alias tables built from choiceInfo and candidates, or nullptr for the plain roulette.
+ */
+template <typename Generator>
+void constructAntTour(const vector<double>& choiceInfo, const vector<vector<int>>& candidates, int n, int start, Generator& gen, vector<int>& route,
+                      double q0 = 0.0, const AliasSampler* sampler = nullptr) {
+    // Unvisited nodes are kept compact so that the fallback scans only the remaining ones
+    vector<int> unvisited(n), position(n);
+    iota(unvisited.begin(), unvisited.end(), 0);
+    iota(position.begin(), position.end(), 0);
+    int remaining = n;
+    auto visit = [&](int node) {
+        int last = unvisited[--remaining];
+        unvisited[position[node]] = last;
+        position[last] = position[node];
+        position[node] = remaining;
+    };
+    auto isVisited = [&](int node) { return position[node] >= remaining; };
+
+    vector<double> weights(n);
+    vector<int> choices(n);
+    uniform_real_distribution<double> uniform(0.0, 1.0);
+
+    route.assign(1, start);
+    visit(start);
+    int currentCity = start;
+    while (remaining > 0) {
+        const double* row = choiceInfo.data() + static_cast<size_t>(currentCity) * n;
+        int nextCity = -1;
+        if (q0 > 0 && uniform(gen) < q0) {
+            // Exploit: take the unvisited candidate with the largest weight
+            if (candidates.empty()) {
+                for (int k = 0; k < remaining; ++k) {
+                    if (nextCity < 0 || row[unvisited[k]] > row[nextCity]) nextCity = unvisited[k];
+                }
+            } else {
+                for (int next : candidates[currentCity]) {
+                    if (!isVisited(next) && (nextCity < 0 || row[next] > row[nextCity])) nextCity = next;
+                }
+            }
+        } else {
+            for (int attempt = 0; sampler != nullptr && attempt < ALIAS_ATTEMPTS; ++attempt) {
+                int next = sampler->sample(currentCity, gen);
+                if (!isVisited(next)) {
+                    nextCity = next;
+                    break;
+                }
+            }
+
+            if (nextCity < 0) {
+                int count = 0;
+                double total = 0.0;
+                if (candidates.empty()) {
+                    for (int k = 0; k < remaining; ++k) {
+                        choices[count] = unvisited[k];
+                        weights[count] = row[unvisited[k]];
+                        total += weights[count++];
+                    }
+                } else {
+                    for (int next : candidates[currentCity]) {
+                        if (isVisited(next)) continue;
+                        choices[count] = next;
+                        weights[count] = row[next];
+                        total += weights[count++];
+                    }
+                }
+
+                if (count > 0) {
+                    nextCity = choices[count - 1];
+                    double target = uniform(gen) * total;
+                    for (int k = 0; k < count; ++k) {
+                        target -= weights[k];
+                        if (target < 0) {
+                            nextCity = choices[k];
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+
+        if (nextCity < 0) {
+            // Every candidate has been visited
+            nextCity = unvisited[0];
+            for (int k = 1; k < remaining; ++k) {
+                if (row[unvisited[k]] > row[nextCity]) nextCity = unvisited[k];
+            }
+        }
+
+        visit(nextCity);
+        route.push_back(nextCity);
+        currentCity = nextCity;
+    }
+    route.push_back(start);
+}
+
+/**
+ * @brief Builds the tours of all ants of one iteration in parallel.
+ *
+ * Ant k of iteration t draws from its own Philox stream (seed, t, k), so the tours do not depend
+ * on the number of threads or on the order in which the ants are built.
+ *
+ * @param matrix A 2D matrix representing distances between nodes.
+ * @param choiceInfo The n x n weights tau^alpha * eta^beta in row-major order.
+ * @param candidates The candidate successors of every node, or an empty list to use all nodes.
+ * @param n The number of nodes in the graph.
+ * @param sampler Alias tables built from choiceInfo and candidates, or nullptr for the plain roulette.
+ * @param seed The seed of the run.
+ * @param iteration The current iteration.
+ * @param numThreads The maximum number of threads to use.
+ * @param routes Receives one closed tour per ant; its size is the number of ants.
+ * @param lengths Receives the total duration of each tour.
+ */
+void constructColony(const MatrixView& matrix, const vector<double>& choiceInfo, const vector<vector<int>>& candidates, int n, const AliasSampler* sampler,
+                     uint64_t seed, int iteration, int numThreads, vector<vector<int>>& routes, vector<double>& lengths) {
+    const int numAnts = static_cast<int>(routes.size());
+    lengths.resize(numAnts);
+    auto worker = [&](int first, int stride) {
+        for (int ant = first; ant < numAnts; ant += stride) {
+            Philox4x32 gen(seed, static_cast<uint32_t>(iteration), static_cast<uint32_t>(ant));
+            constructAntTour(choiceInfo, candidates, n, static_cast<int>(gen() % n), gen, routes[ant], 0.0, sampler);
+            lengths[ant] = calculateTotalDuration(routes[ant], matrix);
+        }
+    };
+
+    const int threads = max(1, min({numThreads, numAnts, numAnts * n / 16384}));
+    vector<thread> pool;
+    for (int t = 1; t < threads; ++t) pool.emplace_back(worker, t, threads);
+    worker(0, threads);
+    for (auto& t : pool) t.join();
+}
+
+/**
+ * @brief Rotates a closed tour so that it starts and ends at node 0.
+ * @param route A closed tour whose first and last entries are equal.
+ * @return The same cycle starting and ending at node 0.
+ */
+vector<int> rotateToDepot(const vector<int>& route) {
+    vector<int> rotated(route.begin(), route.end() - 1);
+    rotate(rotated.begin(), find(rotated.begin(), rotated.end(), 0), rotated.end());
+    rotated.push_back(0);
+    return rotated;
+}
+
+/**
+ * @brief Pheromone trails of an ant colony.
+ *
+ * For asymmetric instances every arc has its own trail, stored row-major. For symmetric instances
+ * (i, j) and (j, i) share one trail, stored as a packed lower triangle, so that a deposit counts in
+ * both directions and evaporation reads and writes half as much memory.
+ *
+ * Deposits made between two calls to update are taken as made after that update's evaporation, so
+ * evaporation, deposits, clamping and the refresh of the choice table take a single pass over the
+ * trails.
+ */
+class PheromoneMatrix {
+public:
+    /**
+     * @brief Creates trails with all entries set to initial.
+     * @param n The number of nodes in the graph.
+     * @param symmetric Whether (i, j) and (j, i) share one trail.
+     * @param evaporationRate The fraction of every trail removed by update.
+     * @param initial The initial trail level.
+     */
+    PheromoneMatrix(int n, bool symmetric, double evaporationRate, double initial)
+        : n(n), symmetric(symmetric), persistence(max(1.0 - evaporationRate, 1e-9)),
+          values(symmetric ? static_cast<size_t>(n) * (n + 1) / 2 : static_cast<size_t>(n) * n, initial) {}
+
+    /**
+     * @brief Returns the trail on the arc from i to j.
+     */
+    double get(int i, int j) const { return values[index(i, j)]; }
+
+    /**
+     * @brief Sets the trail on the arc from i to j (and on the arc back for symmetric trails).
+     */
+    void set(int i, int j, double value) { values[index(i, j)] = value; }
+
+    /**
+     * @brief Adds pheromone to the arc from i to j (and to the arc back for symmetric trails).
+     */
+    void deposit(int i, int j, double amount) { values[index(i, j)] += amount / persistence; }
+
+    /**
+     * @brief Evaporates the trails, clamps them and recomputes the choice table.
+     * @param alpha The importance of pheromone strength in decision-making.
+     * @param eta The n x n heuristic desirabilities in row-major order.
+     * @param choiceInfo Receives the n x n weights tau^alpha * eta in row-major order.
+     * @param tauMin The lower trail limit.
+     * @param tauMax The upper trail limit.
+     */
+    void update(double alpha, const vector<double>& eta, vector<double>& choiceInfo, double tauMin = 0.0, double tauMax = DBL_MAX) {
+        pass(alpha, eta, choiceInfo, [=](double value) { return min(tauMax, max(tauMin, value * persistence)); });
+    }
+
+    /**
+     * @brief Sets every trail to value and recomputes the choice table.
+     * @param value The new trail level.
+     * @param alpha The importance of pheromone strength in decision-making.
+     * @param eta The n x n heuristic desirabilities in row-major order.
+     * @param choiceInfo Receives the n x n weights tau^alpha * eta in row-major order.
+     */
+    void reset(double value, double alpha, const vector<double>& eta, vector<double>& choiceInfo) {
+        pass(alpha, eta, choiceInfo, [=](double) { return value; });
+    }
+
+    /**
+     * @brief Computes the average lambda-branching factor of the trails.
+     *
+     * For each node, counts the arcs whose trail exceeds tau_min + lambda (tau_max - tau_min) of
+     * that node's range. A value close to 1 means that the colony constructs the same tour again
+     * and again.
+     *
+     * @param lambda The fraction of the range an arc must exceed to be counted.
+     * @return The average number of counted arcs per node.
+     */
+    double branchingFactor(double lambda = 0.05) const {
+        long long count = 0;
+        for (int i = 0; i < n; ++i) {
+            double low = DBL_MAX, high = 0.0;
+            for (int j = 0; j < n; ++j) {
+                if (j == i) continue;
+                low = min(low, get(i, j));
+                high = max(high, get(i, j));
+            }
+            double threshold = low + lambda * (high - low);
+            for (int j = 0; j < n; ++j) {
+                if (j != i && get(i, j) >= threshold) ++count;
+            }
+        }
+        return static_cast<double>(count) / n;
+    }
+
+private:
+    static const int TILE = 256; ///< Tile size of the symmetric pass, keeps a tile of the choice table in cache
+
+    size_t index(int i, int j) const {
+        if (!symmetric) return static_cast<size_t>(i) * n + j;
+        if (i < j) swap(i, j);
+        return static_cast<size_t>(i) * (i + 1) / 2 + j;
+    }
+
+    /**
+     * @brief Applies transform to every trail and writes tau^alpha * eta to the choice table.
+     *
+     * The inner loops run over contiguous memory and, for alpha = 1, have no calls, so the compiler
+     * can vectorise them. For symmetric trails row i of the triangle is written to row i of the
+     * choice table and then copied to column i, tile by tile.
+     */
+    template <typename Transform>
+    void pass(double alpha, const vector<double>& eta, vector<double>& choiceInfo, Transform transform) {
+        choiceInfo.resize(static_cast<size_t>(n) * n);
+        auto row = [&](double* __restrict tau, const double* __restrict weights, double* __restrict choice, int count) {
+            if (alpha == 1.0) {
+                for (int j = 0; j < count; ++j) {
+                    tau[j] = transform(tau[j]);
+                    choice[j] = tau[j] * weights[j];
+                }
+            } else {
+                for (int j = 0; j < count; ++j) {
+                    tau[j] = transform(tau[j]);
+                    choice[j] = pow(tau[j], alpha) * weights[j];
+                }
+            }
+        };
+
+        if (!symmetric) {
+            for (int i = 0; i < n; ++i) {
+                size_t offset = static_cast<size_t>(i) * n;
+                row(values.data() + offset, eta.data() + offset, choiceInfo.data() + offset, n);
+            }
+            return;
+        }
+
+        // The lower triangle is processed in tiles; each tile is written to the choice table row by
+        // row and then copied to its mirror image, again row by row, while it is still in cache
+        for (int rowStart = 0; rowStart < n; rowStart += TILE) {
+            int rowEnd = min(n, rowStart + TILE);
+            for (int columnStart = 0; columnStart <= rowStart; columnStart += TILE) {
+                for (int i = rowStart; i < rowEnd; ++i) {
+                    int columnEnd = min(i + 1, columnStart + TILE);
+                    size_t offset = static_cast<size_t>(i) * n + columnStart;
+                    row(values.data() + static_cast<size_t>(i) * (i + 1) / 2 + columnStart, eta.data() + offset,
+                        choiceInfo.data() + offset, columnEnd - columnStart);
+                }
+                for (int j = columnStart; j < min(n, columnStart + TILE); ++j) {
+                    double* mirror = choiceInfo.data() + static_cast<size_t>(j) * n;
+                    for (int i = max(rowStart, j + 1); i < rowEnd; ++i) mirror[i] = choiceInfo[static_cast<size_t>(i) * n + j];
+                }
+            }
+        }
+    }
+
+    int n;
+    bool symmetric;
+    double persistence;    ///< 1 - evaporation rate
+    vector<double> values; ///< Trails, row-major or packed lower triangle
+};
+
+/**
+ * @brief Where an ant colony applies 2-opt before updating the pheromone.
+ */
+enum class LocalSearch {
+    None,          ///< Tours are used as constructed
+    EveryAnt,      ///< Every ant's tour is improved
+    IterationBest, ///< Only the best tour of each iteration is improved
+};
+
+const int LOCAL_SEARCH_NEIGHBOURS = 10; ///< Candidate list size of the 2-opt applied by the ant colonies
+
+/**
+ * @brief Parameters of the ant colony solvers.
+ *
+ * The defaults are those of the plain Ant System; maxMinDefaults and colonySystemDefaults return
+ * the settings used for the other variants. Fields that a variant does not use are ignored.
+ */
+struct AcoParameters {
+    int numAnts = 100;                ///< Number of ants per iteration
+    int numIterations = 10;           ///< Maximum number of iterations
+    double alpha = 1.0;               ///< Importance of pheromone strength in decision-making
+    double beta = 2.0;                ///< Importance of distance in decision-making
+    double evaporationRate = 0.5;     ///< Rate at which pheromones evaporate (weight of the global update in ACS)
+    int numCandidates = 0;            ///< Cheapest successors an ant considers at each step, 0 for all nodes
+    bool symmetric = false;           ///< Whether both directions of an edge share one trail
+    bool aliasSampling = false;       ///< Whether to draw successors from alias tables (AS and MMAS)
+    uint64_t seed = random_device{}(); ///< Seed of the random number streams; equal seeds give equal results
+    int numThreads = static_cast<int>(thread::hardware_concurrency()); ///< Threads building tours (AS and MMAS)
+    LocalSearch localSearch = LocalSearch::None; ///< Which tours 2-opt improves before the pheromone update
+
+    double pBest = 0.05;              ///< MMAS: probability of building the best tour once converged, sets tau_min
+    double localEvaporationRate = 0.1; ///< ACS: weight of the local update towards tau0
+    double q0 = 0.9;                  ///< ACS: probability of taking the best candidate instead of sampling
+    int numIslands = 0;               ///< Islands: independent colonies, 0 for one per thread
+    int migrationInterval = 25;       ///< Islands: iterations between exchanges of best tours, 0 to disable
+
+    int stagnationIterations = 0;     ///< Stop after this many iterations without improvement, 0 to disable
+    double minBranchingFactor = 0.0;  ///< Stop once the average lambda-branching factor falls below this, 0 to disable
+    double timeLimit = 0.0;           ///< Stop after this many seconds, 0 to disable
+
+    /**
+     * @brief Returns the default parameters of the MAX-MIN Ant System.
+     */
+    static AcoParameters maxMinDefaults() {
+        AcoParameters parameters;
+        parameters.numAnts = 50;
+        parameters.numIterations = 200;
+        parameters.evaporationRate = 0.1;
+        parameters.numCandidates = 20;
+        return parameters;
+    }
+
+    /**
+     * @brief Returns the default parameters of Ant Colony System.
+     */
+    static AcoParameters colonySystemDefaults() {
+        AcoParameters parameters;
+        parameters.numAnts = 10;
+        parameters.numIterations = 500;
+        parameters.evaporationRate = 0.1;
+        parameters.numCandidates = 20;
+        return parameters;
+    }
+};
+
+/**
+ * @brief Evaluates the stopping rules of an ant colony run after each iteration.
+ *
+ * A run stops after numIterations iterations, or earlier when the best tour has not improved for
+ * stagnationIterations iterations, when the colony has converged (the average lambda-branching
+ * factor of the trails, checked every tenth iteration, is below minBranchingFactor) or when
+ * timeLimit seconds have passed.
+ */
+class AcoTermination {
+public:
+    explicit AcoTermination(const AcoParameters& parameters) : parameters(parameters), start(chrono::steady_clock::now()) {}
+
+    /**
+     * @brief Records the end of an iteration.
+     * @param iteration The iteration that has just finished.
+     * @param improved Whether it improved the best tour.
+     * @param pheromone The trails after the iteration's update.
+     * @return True if the run should stop.
+     */
+    bool stop(int iteration, bool improved, const PheromoneMatrix& pheromone) {
+        if (improved) lastImprovement = iteration;
+        if (parameters.stagnationIterations > 0 && iteration - lastImprovement >= parameters.stagnationIterations) return true;
+        if (parameters.timeLimit > 0 && chrono::duration<double>(chrono::steady_clock::now() - start).count() >= parameters.timeLimit) return true;
+        return parameters.minBranchingFactor > 0 && iteration % 10 == 9 && pheromone.branchingFactor() < parameters.minBranchingFactor;
+    }
+
+private:
+    const AcoParameters& parameters;
+    chrono::steady_clock::time_point start;
+    int lastImprovement = -1;
+};
+
+/**
+ * @brief Applies 2-opt to the tours of one iteration as selected by parameters.localSearch.
+ * @param matrix A 2D matrix representing distances between nodes.
+ * @param n The number of nodes in the graph.
+ * @param neighbours The candidate lists of the 2-opt.
+ * @param parameters The colony parameters.
+ * @param routes The tours of the ants, improved in place.
+ * @param lengths The total durations of the tours, updated in place.
+ */
+void improveColony(const MatrixView& matrix, int n, const vector<vector<int>>& neighbours, const AcoParameters& parameters, vector<vector<int>>& routes, vector<double>& lengths) {
+    const int numAnts = static_cast<int>(routes.size());
+    auto improve = [&](int ant) {
+        auto result = twoOpt(matrix, n, routes[ant], neighbours, parameters.symmetric);
+        routes[ant] = move(result.first);
+        lengths[ant] = result.second;
+    };
+
+    if (parameters.localSearch == LocalSearch::IterationBest) {
+        improve(static_cast<int>(min_element(lengths.begin(), lengths.end()) - lengths.begin()));
+    } else if (parameters.localSearch == LocalSearch::EveryAnt) {
+        const int threads = max(1, min({parameters.numThreads, numAnts, numAnts * n / 16384}));
+        auto worker = [&](int first) {
+            for (int ant = first; ant < numAnts; ant += threads) improve(ant);
+        };
+        vector<thread> pool;
+        for (int t = 1; t < threads; ++t) pool.emplace_back(worker, t);
+        worker(0);
+        for (auto& t : pool) t.join();
+    }
+}
+
+/**
+ * @brief Solves the TSP using the Ant Colony Optimization (ACO) algorithm.
+ * @param matrix A 2D matrix representing distances between nodes.
+ * @param n The number of nodes in the graph.
+ * @param parameters The colony size, pheromone model and stopping rules. Without candidate lists
+ *        the alias tables take O(n^2) memory.
+ * @return A pair consisting of the best route found and its total duration.
+ */
+pair<vector<int>, double> antColonyOptimization(const MatrixView& matrix, int n, const AcoParameters& parameters = AcoParameters()) {
+    const double alpha = parameters.alpha;
+    vector<double> eta = heuristicInformation(matrix, n, parameters.beta);
+    vector<double> choiceInfo;
+    PheromoneMatrix pheromone(n, parameters.symmetric, parameters.evaporationRate, 1.0); ///< Initial pheromone levels
+    pheromone.reset(1.0, alpha, eta, choiceInfo);
+    vector<vector<int>> candidates; ///< Without candidate lists ants consider every unvisited node
+    if (parameters.numCandidates > 0) candidates = buildCandidateLists(matrix, n, parameters.numCandidates);
+    AliasSampler sampler;
+    if (parameters.aliasSampling && n > 1) sampler.build(choiceInfo, candidates, n);
+    vector<vector<int>> neighbours;
+    if (parameters.localSearch != LocalSearch::None) neighbours = buildCandidateLists(matrix, n, LOCAL_SEARCH_NEIGHBOURS);
+    vector<int> bestRoute;
+    double bestLength = DBL_MAX;
+
+    AcoTermination termination(parameters);
+    vector<vector<int>> routes(parameters.numAnts); ///< Routes taken by ants
+    vector<double> routeLengths;                    ///< Lengths of these routes
+    for (int iteration = 0; iteration < parameters.numIterations; ++iteration) {
+        constructColony(matrix, choiceInfo, candidates, n, sampler.empty() ? nullptr : &sampler, parameters.seed, iteration, parameters.numThreads, routes, routeLengths);
+        improveColony(matrix, n, neighbours, parameters, routes, routeLengths);
+
+        // Ants are processed in order so that the result does not depend on the thread count
+        bool improved = false;
+        for (int ant = 0; ant < parameters.numAnts; ++ant) {
+            const vector<int>& route = routes[ant];
+            double routeLength = routeLengths[ant];
+
+            // Update the best route
+            if (routeLength < bestLength) {
+                bestRoute = route;
+                bestLength = routeLength;
+                improved = true;
+            }
+
+            // Deposit pheromones along the route; they are applied after this iteration's evaporation
+            for (int j = 0; j < n; ++j) {
+                pheromone.deposit(route[j], route[j + 1], 1.0 / routeLength);
+            }
+        }
+
+        // Evaporate pheromones and refresh the choice table
+        pheromone.update(alpha, eta, choiceInfo);
+        if (!sampler.empty()) sampler.build(choiceInfo, candidates, n);
+        if (termination.stop(iteration, improved, pheromone)) break;
+    }
+
+    return {bestRoute, bestLength};
+}
+
+/**
+ * @brief One MAX-MIN Ant System colony, advanced an iteration at a time.
+ *
+ * Only the best ant of each iteration deposits pheromone, and the trails are clamped to
+ * [tau_min, tau_max] where tau_max = 1 / (rho * best length). Trails start at tau_max and are
+ * reset to it when the branching factor shows that the colony has converged, so the search keeps
+ * exploring instead of rebuilding the same tour. The heuristic information and candidate lists
+ * are only read, so several colonies can share them.
+ */
+class MaxMinColony {
+public:
+    /**
+     * @brief Creates a colony with trails at tau_max.
+     * @param matrix A 2D matrix representing distances between nodes.
+     * @param n The number of nodes in the graph.
+     * @param parameters The colony size, pheromone model and stopping rules; must outlive the colony.
+     * @param eta The heuristic information from heuristicInformation.
+     * @param candidates The successors an ant considers at each step.
+     * @param neighbours The candidate lists of the 2-opt, empty without local search.
+     * @param initial The tour the colony starts from as its best, with its total duration.
+     */
+    MaxMinColony(const MatrixView& matrix, int n, const AcoParameters& parameters, const vector<double>& eta,
+                 const vector<vector<int>>& candidates, const vector<vector<int>>& neighbours, const pair<vector<int>, double>& initial)
+        : matrix(matrix), n(n), parameters(parameters), eta(eta), candidates(candidates), neighbours(neighbours),
+          bestTour(initial.first), bestTourLength(initial.second),
+          pheromone(n, parameters.symmetric, parameters.evaporationRate, 0.0), termination(parameters), routes(parameters.numAnts) {
+        updateBounds();
+        pheromone.reset(tauMax, parameters.alpha, eta, choiceInfo);
+        if (parameters.aliasSampling) sampler.build(choiceInfo, candidates, n);
+    }
+
+    /**
+     * @brief Builds the tours of one iteration and updates the trails.
+     * @param iteration The iteration number, which selects the random number streams.
+     * @return True if the stopping rules end the run.
+     */
+    bool iterate(int iteration) {
+        constructColony(matrix, choiceInfo, candidates, n, sampler.empty() ? nullptr : &sampler, parameters.seed, iteration, parameters.numThreads, routes, routeLengths);
+        improveColony(matrix, n, neighbours, parameters, routes, routeLengths);
+        int iterationBest = static_cast<int>(min_element(routeLengths.begin(), routeLengths.end()) - routeLengths.begin());
+        const vector<int>& iterationRoute = routes[iterationBest];
+        double iterationLength = routeLengths[iterationBest];
+
+        bool improved = immigrated || iterationLength < bestTourLength;
+        immigrated = false;
+        if (iterationLength < bestTourLength) {
+            bestTourLength = iterationLength;
+            bestTour = iterationRoute;
+            updateBounds();
+        }
+
+        // Evaporate, let the iteration-best ant (every tenth iteration the best-so-far) deposit,
+        // then clamp to the trail limits
+        const bool useBest = iteration % 10 == 9;
+        const vector<int>& depositRoute = useBest ? bestTour : iterationRoute;
+        for (int j = 0; j < n; ++j) {
+            pheromone.deposit(depositRoute[j], depositRoute[j + 1], 1.0 / (useBest ? bestTourLength : iterationLength));
+        }
+        pheromone.update(parameters.alpha, eta, choiceInfo, tauMin, tauMax);
+        if (termination.stop(iteration, improved, pheromone)) return true;
+
+        // Restart from tau_max once nearly every node has a single dominant successor
+        if (iteration % 10 == 9 && pheromone.branchingFactor() < 1.05) {
+            pheromone.reset(tauMax, parameters.alpha, eta, choiceInfo);
+        }
+        if (!sampler.empty()) sampler.build(choiceInfo, candidates, n);
+        return false;
+    }
+
+    /**
+     * @brief Offers a tour found elsewhere; it becomes the best-so-far tour if it is shorter.
+     * @param route The tour, closed.
+     * @param length Its total duration.
+     */
+    void immigrate(const vector<int>& route, double length) {
+        if (length >= bestTourLength) return;
+        bestTour = route;
+        bestTourLength = length;
+        updateBounds();
+        immigrated = true;
+    }
+
+    const vector<int>& bestRoute() const { return bestTour; }
+    double bestLength() const { return bestTourLength; }
+
+private:
+    void updateBounds() {
+        tauMax = 1.0 / (parameters.evaporationRate * bestTourLength);
+        double root = pow(parameters.pBest, 1.0 / n);
+        tauMin = min(tauMax, tauMax * (1 - root) / ((n / 2.0 - 1) * root));
+    }
+
+    const MatrixView& matrix;
+    const int n;
+    const AcoParameters& parameters;
+    const vector<double>& eta;
+    const vector<vector<int>>& candidates;
+    const vector<vector<int>>& neighbours;
+
+    vector<int> bestTour;
+    double bestTourLength;
+    bool immigrated = false;  ///< Whether a better tour arrived since the last iteration
+    double tauMax = 0, tauMin = 0;
+    PheromoneMatrix pheromone;
+    vector<double> choiceInfo;
+    AliasSampler sampler;
+    AcoTermination termination;
+    vector<vector<int>> routes;
+    vector<double> routeLengths;
+};
+
+/**
+ * @brief Solves the TSP using the MAX-MIN Ant System (MMAS).
+ * @param matrix A 2D matrix representing distances between nodes.
+ * @param n The number of nodes in the graph.
+ * @param parameters The colony size, pheromone model and stopping rules. A minimum branching
+ *        factor above 1.05 stops the run before any restart.
+ * @return A pair consisting of the best route found and its total duration.
+ * @note See MaxMinColony for the pheromone model.
+ */
+pair<vector<int>, double> maxMinAntSystem(const MatrixView& matrix, int n, const AcoParameters& parameters = AcoParameters::maxMinDefaults()) {
+    if (n <= 3) return bruteForce(matrix, n);
+
+    vector<double> eta = heuristicInformation(matrix, n, parameters.beta);
+    vector<vector<int>> candidates = buildCandidateLists(matrix, n, parameters.numCandidates);
+    vector<vector<int>> neighbours;
+    if (parameters.localSearch != LocalSearch::None) neighbours = buildCandidateLists(matrix, n, LOCAL_SEARCH_NEIGHBOURS);
+
+    MaxMinColony colony(matrix, n, parameters, eta, candidates, neighbours, nearestNeighbour(matrix, n));
+    for (int iteration = 0; iteration < parameters.numIterations; ++iteration) {
+        if (colony.iterate(iteration)) break;
+    }
+
+    vector<int> bestRoute = rotateToDepot(colony.bestRoute());
+    return {bestRoute, calculateTotalDuration(bestRoute, matrix)};
+}
+
+/**
+ * @brief Single-producer single-consumer ring of tours sent from one island to the next.
+ *
+ * The counters stamp every message with its migration epoch: the sender fills slot
+ * written % CAPACITY and publishes it by advancing written with release semantics, and the
+ * receiver copies it out after an acquire load and frees it by advancing read. No locks are taken
+ * and neither side waits unless the ring is full or empty. Once one side has finished its run the
+ * other stops waiting for it, so islands may end at different iterations.
+ */
+class MigrationMailbox {
+public:
+    static const int CAPACITY = 4;
+
+    /**
+     * @brief Sends a tour, waiting while the receiver is CAPACITY epochs behind.
+     * @param route The tour, closed.
+     * @param length Its total duration.
+     */
+    void send(const vector<int>& route, double length) {
+        uint64_t epoch = written.load(memory_order_relaxed);
+        while (epoch - read.load(memory_order_acquire) == CAPACITY) {
+            if (receiverDone.load(memory_order_acquire)) return;
+            this_thread::yield();
+        }
+        Slot& slot = slots[epoch % CAPACITY];
+        slot.route = route;
+        slot.length = length;
+        written.store(epoch + 1, memory_order_release);
+    }
+
+    /**
+     * @brief Receives the tour of the next epoch, waiting until it has been sent.
+     * @param route Receives the tour.
+     * @param length Receives its total duration.
+     * @return False if the sender finished without sending it.
+     */
+    bool receive(vector<int>& route, double& length) {
+        uint64_t epoch = read.load(memory_order_relaxed);
+        while (written.load(memory_order_acquire) == epoch) {
+            if (senderDone.load(memory_order_acquire)) {
+                if (written.load(memory_order_acquire) == epoch) return false;
+                break;
+            }
+            this_thread::yield();
+        }
+        const Slot& slot = slots[epoch % CAPACITY];
+        route = slot.route;
+        length = slot.length;
+        read.store(epoch + 1, memory_order_release);
+        return true;
+    }
+
+    void closeSender() { senderDone.store(true, memory_order_release); }
+    void closeReceiver() { receiverDone.store(true, memory_order_release); }
+
+private:
+    struct Slot {
+        vector<int> route;
+        double length = 0.0;
+    };
+
+    array<Slot, CAPACITY> slots;
+    alignas(64) atomic<uint64_t> written{0}; ///< Epochs sent, advanced by the sender only
+    alignas(64) atomic<uint64_t> read{0};    ///< Epochs received, advanced by the receiver only
+    atomic<bool> senderDone{false};
+    atomic<bool> receiverDone{false};
+};
+
+/**
+ * @brief Solves the TSP with an island model of MAX-MIN Ant System colonies.
+ *
+ * Each island is a full colony with its own trails and random number streams, run on its own
+ * thread; the heuristic information and candidate lists are shared read-only. Every
+ * migrationInterval iterations an island sends its best tour to the next island on a ring and
+ * adopts the tour received from the previous one if it is shorter. The only synchronisation is
+ * this exchange between neighbours, so islands never wait for the whole group. Trails are
+ * allocated by the island's own thread, which places them on its NUMA node under first-touch
+ * allocation. For equal seeds and no time limit the result does not depend on thread timing.
+ *
+ * @param matrix A 2D matrix representing distances between nodes.
+ * @param n The number of nodes in the graph.
+ * @param parameters The settings of each colony, the number of islands and the migration
+ *        interval. numThreads is shared out between the islands.
+ * @return A pair consisting of the best route found by any island and its total duration.
+ * @note Every island holds its own n x n trails and choice table.
+ */
+pair<vector<int>, double> islandAntSystem(const MatrixView& matrix, int n, const AcoParameters& parameters = AcoParameters::maxMinDefaults()) {
+    if (n <= 3) return bruteForce(matrix, n);
+
+    const int numIslands = parameters.numIslands > 0 ? parameters.numIslands : max(1, parameters.numThreads);
+    vector<double> eta = heuristicInformation(matrix, n, parameters.beta);
+    vector<vector<int>> candidates = buildCandidateLists(matrix, n, parameters.numCandidates);
+    vector<vector<int>> neighbours;
+    if (parameters.localSearch != LocalSearch::None) neighbours = buildCandidateLists(matrix, n, LOCAL_SEARCH_NEIGHBOURS);
+    const auto initial = nearestNeighbour(matrix, n);
+
+    vector<AcoParameters> islandParameters(numIslands, parameters);
+    for (int island = 0; island < numIslands; ++island) {
+        islandParameters[island].seed = parameters.seed + island * 0x9E3779B97F4A7C15ull;
+        islandParameters[island].numThreads = max(1, parameters.numThreads / numIslands);
+    }
+
+    vector<MigrationMailbox> mailboxes(numIslands); ///< mailboxes[i] carries tours from island i to island i + 1
+    vector<pair<vector<int>, double>> results(numIslands);
+    auto runIsland = [&](int island) {
+        MaxMinColony colony(matrix, n, islandParameters[island], eta, candidates, neighbours, initial);
+        MigrationMailbox& outbox = mailboxes[island];
+        MigrationMailbox& inbox = mailboxes[(island + numIslands - 1) % numIslands];
+        vector<int> immigrant;
+        double immigrantLength;
+        for (int iteration = 0; iteration < parameters.numIterations; ++iteration) {
+            if (colony.iterate(iteration)) break;
+            if (numIslands > 1 && parameters.migrationInterval > 0 && iteration % parameters.migrationInterval == parameters.migrationInterval - 1) {
+                outbox.send(colony.bestRoute(), colony.bestLength());
+                if (inbox.receive(immigrant, immigrantLength)) colony.immigrate(immigrant, immigrantLength);
+            }
+        }
+        outbox.closeSender();
+        inbox.closeReceiver();
+        results[island] = {colony.bestRoute(), colony.bestLength()};
+    };
+
+    vector<thread> pool;
+    for (int island = 1; island < numIslands; ++island) pool.emplace_back(runIsland, island);
+    runIsland(0);
+    for (auto& t : pool) t.join();
+
+    // Ties go to the lowest island so that the result does not depend on thread timing
+    int best = 0;
+    for (int island = 1; island < numIslands; ++island) {
+        if (results[island].second < results[best].second) best = island;
+    }
+    vector<int> bestRoute = rotateToDepot(results[best].first);
+    return {bestRoute, calculateTotalDuration(bestRoute, matrix)};
+}
+
+/**
+ * @brief Solves the TSP using Ant Colony System (ACS).
+ *
+ * Each ant takes the best candidate with probability q0 and samples otherwise. Every arc an ant
+ * uses is moved towards the initial trail tau0 = 1 / (n * nearest-neighbour length), which makes
+ * the following ants less likely to repeat it, and only the best-so-far tour is reinforced at the
+ * end of an iteration. Both updates touch O(n) arcs, so no pass over the whole pheromone matrix is
+ * needed. alpha is fixed to 1.
+ *
+ * @param matrix A 2D matrix representing distances between nodes.
+ * @param n The number of nodes in the graph.
+ * @param parameters The colony size, pheromone model and stopping rules.
+ * @return A pair consisting of the best route found and its total duration.
+ * @note The ants are built one after another, since each one sees the local updates of the previous ones.
+ *       Local search is applied to the finished tours, after the local updates.
+ */
+pair<vector<int>, double> antColonySystem(const MatrixView& matrix, int n, const AcoParameters& parameters = AcoParameters::colonySystemDefaults()) {
+    if (n <= 3) return bruteForce(matrix, n);
+
+    vector<double> eta = heuristicInformation(matrix, n, parameters.beta);
+    vector<vector<int>> candidates = buildCandidateLists(matrix, n, parameters.numCandidates);
+    vector<vector<int>> neighbours;
+    if (parameters.localSearch != LocalSearch::None) neighbours = buildCandidateLists(matrix, n, LOCAL_SEARCH_NEIGHBOURS);
+
+    auto initial = nearestNeighbour(matrix, n);
+    vector<int> bestRoute = initial.first;
+    double bestLength = initial.second;
+
+    // With alpha = 1 the choice information is tau * eta^beta and is updated arc by arc
+    const double tau0 = 1.0 / (n * bestLength);
+    PheromoneMatrix pheromone(n, parameters.symmetric, 0.0, tau0);
+    vector<double> choiceInfo;
+    pheromone.reset(tau0, 1.0, eta, choiceInfo);
+    auto setTrail = [&](int from, int to, double value) {
+        pheromone.set(from, to, value);
+        choiceInfo[static_cast<size_t>(from) * n + to] = value * eta[static_cast<size_t>(from) * n + to];
+        if (parameters.symmetric) choiceInfo[static_cast<size_t>(to) * n + from] = value * eta[static_cast<size_t>(to) * n + from];
+    };
+
+    AcoTermination termination(parameters);
+    const double xi = parameters.localEvaporationRate, rho = parameters.evaporationRate;
+    vector<vector<int>> routes(parameters.numAnts);
+    vector<double> routeLengths(parameters.numAnts);
+    for (int iteration = 0; iteration < parameters.numIterations; ++iteration) {
+        for (int ant = 0; ant < parameters.numAnts; ++ant) {
+            vector<int>& route = routes[ant];
+            Philox4x32 gen(parameters.seed, static_cast<uint32_t>(iteration), static_cast<uint32_t>(ant));
+            constructAntTour(choiceInfo, candidates, n, static_cast<int>(gen() % n), gen, route, parameters.q0);
+            routeLengths[ant] = calculateTotalDuration(route, matrix);
+
+            // Local update: wear down the arcs just used
+            for (int j = 0; j < n; ++j) {
+                setTrail(route[j], route[j + 1], (1 - xi) * pheromone.get(route[j], route[j + 1]) + xi * tau0);
+            }
+        }
+
+        improveColony(matrix, n, neighbours, parameters, routes, routeLengths);
+        bool improved = false;
+        for (int ant = 0; ant < parameters.numAnts; ++ant) {
+            if (routeLengths[ant] < bestLength) {
+                bestLength = routeLengths[ant];
+                bestRoute = routes[ant];
+                improved = true;
+            }
+        }
+
+        // Global update: reinforce the best-so-far tour only
+        for (int j = 0; j < n; ++j) {
+            setTrail(bestRoute[j], bestRoute[j + 1], (1 - rho) * pheromone.get(bestRoute[j], bestRoute[j + 1]) + rho / bestLength);
+        }
+        if (termination.stop(iteration, improved, pheromone)) break;
+    }
+
+    bestRoute = rotateToDepot(bestRoute);
+    return {bestRoute, calculateTotalDuration(bestRoute, matrix)};
+}
+
+/**
+ * @brief Parameters of the genetic algorithm.
+ */
+struct GaParameters {
+    int populationSize = 100;          ///< Number of tours kept
+    int numGenerations = 1000;         ///< Maximum number of generations
+    int numChildren = 30;              ///< EAX: AB-cycles tried for every pair of parents
+    double mutationRate = 0.1;         ///< OX: probability of reversing a random segment of a child
+    bool symmetric = false;            ///< Whether to use EAX (symmetric matrices only) instead of OX
+    uint64_t seed = random_device{}(); ///< Seed of the random number streams; equal seeds give equal results
+    int numThreads = static_cast<int>(thread::hardware_concurrency()); ///< Threads building offspring
+    int stagnationGenerations = 0;     ///< Stop after this many generations without improvement, 0 to disable
+    double timeLimit = 0.0;            ///< Stop after this many seconds, 0 to disable
+};
+
+/**
+ * @brief Edge Assembly Crossover (Nagata and Kobayashi) for symmetric matrices.
+ *
+ * The edges of parent A that are not in parent B and those of B that are not in A are split into
+ * AB-cycles, closed walks that alternate between A-edges and B-edges. A child is A with the A-edges
+ * of one AB-cycle replaced by its B-edges; this leaves a set of subtours, which are merged greedily,
+ * smallest first, by exchanging one edge of the subtour and one edge of a neighbouring tour for two
+ * edges between them. Several AB-cycles are tried and the shortest child is kept (the EAX-1AB
+ * strategy). Tours are held as adjacency lists, so a child costs O(n) to build regardless of the
+ * matrix. The buffers are allocated once and reused for every crossover of a thread.
+ */
+class EdgeAssembly {
+public:
+    /**
+     * @brief Allocates the buffers for instances of n nodes.
+     * @param matrix A symmetric 2D matrix representing distances between nodes.
+     * @param n The number of nodes in the graph.
+     * @param neighbours Candidate lists searched when merging subtours.
+     */
+    EdgeAssembly(const MatrixView& matrix, int n, const vector<vector<int>>& neighbours)
+        : matrix(matrix), n(n), neighbours(neighbours), linkA(2 * n), linkB(2 * n), link(2 * n), bestLink(2 * n),
+          remainingA(2 * n), remainingB(2 * n), countA(n), countB(n), positionEven(n, -1), positionOdd(n, -1),
+          label(n), componentSize(n), componentNode(n) {}
+
+    /**
+     * @brief Builds the best child of two parents that is shorter than parent A.
+     * @param parentA The tour the children are derived from, closed.
+     * @param lengthA Its total duration.
+     * @param parentB The tour contributing edges, closed.
+     * @param numChildren The number of AB-cycles to try.
+     * @param gen The random number generator choosing the AB-cycles.
+     * @param child Receives the child as a closed tour starting at node 0.
+     * @return The child's total duration, or DBL_MAX if no child is shorter than parent A.
+     */
+    template <typename Generator>
+    double cross(const vector<int>& parentA, double lengthA, const vector<int>& parentB, int numChildren, Generator& gen, vector<int>& child) {
+        toLinks(parentA, linkA);
+        toLinks(parentB, linkB);
+        buildCycles(gen);
+
+        const int numCycles = static_cast<int>(cycleStarts.size()) - 1;
+        order.resize(numCycles);
+        iota(order.begin(), order.end(), 0);
+        shuffle(order.begin(), order.end(), gen);
+
+        double bestLength = lengthA - 1e-9;
+        bool found = false;
+        for (int c = 0; c < min(numChildren, numCycles); ++c) {
+            link = linkA;
+            double length = lengthA + applyCycle(order[c]);
+            length += mergeSubtours();
+            if (length < bestLength) {
+                bestLength = length;
+                bestLink = link;
+                found = true;
+            }
+        }
+        if (!found) return DBL_MAX;
+
+        child.resize(n + 1);
+        for (int i = 0, previous = -1, node = 0; i < n; ++i) {
+            child[i] = node;
+            int next = bestLink[2 * node] != previous ? bestLink[2 * node] : bestLink[2 * node + 1];
+            previous = node;
+            node = next;
+        }
+        child[n] = 0;
+        return calculateTotalDuration(child, matrix);
+    }
+
+private:
+    /**
+     * @brief Converts a closed tour into the two neighbours of every node.
+     */
+    void toLinks(const vector<int>& route, vector<int>& links) const {
+        for (int i = 0; i < n; ++i) {
+            links[2 * route[i + 1]] = route[i];
+            links[2 * route[i] + 1] = route[i + 1];
+        }
+    }
+
+    static bool adjacent(const vector<int>& links, int u, int v) {
+        return links[2 * u] == v || links[2 * u + 1] == v;
+    }
+
+    /**
+     * @brief Takes one remaining edge at node u chosen at random and removes it from both ends.
+     */
+    template <typename Generator>
+    static int takeEdge(vector<int>& remaining, vector<int>& count, int u, Generator& gen) {
+        int slot = count[u] == 2 ? static_cast<int>(gen() & 1) : 0;
+        int v = remaining[2 * u + slot];
+        remaining[2 * u + slot] = remaining[2 * u + --count[u]];
+        int back = remaining[2 * v] == u ? 0 : 1;
+        remaining[2 * v + back] = remaining[2 * v + --count[v]];
+        return v;
+    }
+
+    /**
+     * @brief Decomposes the edges in which the parents differ into AB-cycles.
+     *
+     * A walk alternately follows A-edges and B-edges, consuming them. When it returns to a node it
+     * has left by an edge of the same kind as the one it would take next, the part of the walk in
+     * between closes an AB-cycle and is cut off. Each cycle is stored starting with an A-edge.
+     */
+    template <typename Generator>
+    void buildCycles(Generator& gen) {
+        for (int u = 0; u < n; ++u) {
+            countA[u] = countB[u] = 0;
+            for (int side = 0; side < 2; ++side) {
+                int a = linkA[2 * u + side], b = linkB[2 * u + side];
+                if (!adjacent(linkB, u, a)) remainingA[2 * u + countA[u]++] = a;
+                if (!adjacent(linkA, u, b)) remainingB[2 * u + countB[u]++] = b;
+            }
+        }
+
+        cycles.clear();
+        cycleStarts.assign(1, 0);
+        for (int start = 0; start < n; ++start) {
+            while (countA[start] > 0) {
+                path.assign(1, start);
+                positionEven[start] = 0;
+                while (true) {
+                    const int k = static_cast<int>(path.size()) - 1;
+                    const int u = path[k];
+                    // Even positions are left by an A-edge, odd positions by a B-edge
+                    int v = k % 2 == 0 ? takeEdge(remainingA, countA, u, gen) : takeEdge(remainingB, countB, u, gen);
+                    vector<int>& positions = k % 2 == 0 ? positionOdd : positionEven;
+                    if (positions[v] < 0) {
+                        positions[v] = k + 1;
+                        path.push_back(v);
+                        continue;
+                    }
+
+                    // The walk from the earlier visit of v back to v alternates, so it is an AB-cycle
+                    const int first = positions[v];
+                    for (int t = first + (first % 2); t < k + 1; ++t) cycles.push_back(path[t]);
+                    if (first % 2 == 1) cycles.push_back(path[first]);
+                    cycleStarts.push_back(static_cast<int>(cycles.size()));
+                    for (int t = first + 1; t <= k; ++t) (t % 2 == 0 ? positionEven : positionOdd)[path[t]] = -1;
+                    path.resize(first + 1);
+                    if (first == 0 && countA[start] == 0) break;
+                }
+                positionEven[start] = -1;
+            }
+        }
+    }
+
+    /**
+     * @brief Replaces the A-edges of an AB-cycle in link by its B-edges.
+     * @return The change in tour length.
+     */
+    double applyCycle(int cycle) {
+        const int first = cycleStarts[cycle], size = cycleStarts[cycle + 1] - first;
+        double delta = 0.0;
+        for (int t = 0; t < size; t += 2) {
+            int u = cycles[first + t], v = cycles[first + (t + 1) % size];
+            link[2 * u + (link[2 * u] == v ? 0 : 1)] = -1;
+            link[2 * v + (link[2 * v] == u ? 0 : 1)] = -1;
+            delta -= matrix[u][v];
+        }
+        for (int t = 1; t < size; t += 2) {
+            int u = cycles[first + t], v = cycles[first + (t + 1) % size];
+            link[2 * u + (link[2 * u] == -1 ? 0 : 1)] = v;
+            link[2 * v + (link[2 * v] == -1 ? 0 : 1)] = u;
+            delta += matrix[u][v];
+        }
+        return delta;
+    }
+
+    /**
+     * @brief Joins the subtours in link into one tour, always merging the smallest subtour.
+     * @return The change in tour length.
+     */
+    double mergeSubtours() {
+        fill(label.begin(), label.end(), -1);
+        int numComponents = 0;
+        for (int start = 0; start < n; ++start) {
+            if (label[start] >= 0) continue;
+            int size = 0;
+            for (int previous = -1, node = start; label[node] < 0; ++size) {
+                label[node] = numComponents;
+                int next = link[2 * node] != previous ? link[2 * node] : link[2 * node + 1];
+                previous = node;
+                node = next;
+            }
+            componentSize[numComponents] = size;
+            componentNode[numComponents++] = start;
+        }
+
+        double delta = 0.0;
+        for (int remaining = numComponents; remaining > 1; --remaining) {
+            int smallest = -1;
+            for (int c = 0; c < numComponents; ++c) {
+                if (componentSize[c] > 0 && (smallest < 0 || componentSize[c] < componentSize[smallest])) smallest = c;
+            }
+
+            members.clear();
+            for (int previous = -1, node = componentNode[smallest]; members.empty() || node != componentNode[smallest];) {
+                members.push_back(node);
+                int next = link[2 * node] != previous ? link[2 * node] : link[2 * node + 1];
+                previous = node;
+                node = next;
+            }
+
+            // Exchange edge (u, u2) of the subtour and edge (v, v2) outside it for (u, v), (u2, v2) or (u, v2), (u2, v)
+            double bestGain = DBL_MAX;
+            int bestU = -1, bestU2 = -1, bestV = -1, bestV2 = -1;
+            bool crossed = false;
+            auto consider = [&](int u, int v) {
+                for (int side = 0; side < 2; ++side) {
+                    int u2 = link[2 * u + side];
+                    for (int otherSide = 0; otherSide < 2; ++otherSide) {
+                        int v2 = link[2 * v + otherSide];
+                        double removed = matrix[u][u2] + matrix[v][v2];
+                        double straight = matrix[u][v] + matrix[u2][v2] - removed;
+                        double cross = matrix[u][v2] + matrix[u2][v] - removed;
+                        if (straight < bestGain) {
+                            bestGain = straight;
+                            bestU = u, bestU2 = u2, bestV = v, bestV2 = v2, crossed = false;
+                        }
+                        if (cross < bestGain) {
+                            bestGain = cross;
+                            bestU = u, bestU2 = u2, bestV = v, bestV2 = v2, crossed = true;
+                        }
+                    }
+                }
+            };
+            for (int u : members) {
+                for (int v : neighbours[u]) {
+                    if (label[v] != smallest) consider(u, v);
+                }
+            }
+            if (bestU < 0) {
+                // No candidate leaves the subtour; connect its first node to any other tour
+                for (int v = 0; v < n && bestU < 0; ++v) {
+                    if (label[v] != smallest) consider(members[0], v);
+                }
+            }
+
+            int target = label[bestV];
+            if (crossed) swap(bestV, bestV2);
+            link[2 * bestU + (link[2 * bestU] == bestU2 ? 0 : 1)] = bestV;
+            link[2 * bestU2 + (link[2 * bestU2] == bestU ? 0 : 1)] = bestV2;
+            link[2 * bestV + (link[2 * bestV] == bestV2 ? 0 : 1)] = bestU;
+            link[2 * bestV2 + (link[2 * bestV2] == bestV ? 0 : 1)] = bestU2;
+            delta += bestGain;
+
+            for (int u : members) label[u] = target;
+            componentSize[target] += componentSize[smallest];
+            componentSize[smallest] = 0;
+        }
+        return delta;
+    }
+
+    const MatrixView& matrix;
+    const int n;
+    const vector<vector<int>>& neighbours;
+    vector<int> linkA, linkB, link, bestLink;   ///< Two neighbours per node of A, B, the child and the best child
+    vector<int> remainingA, remainingB;         ///< Edges not yet assigned to an AB-cycle, two slots per node
+    vector<int> countA, countB;                 ///< Used slots of remainingA and remainingB
+    vector<int> positionEven, positionOdd;      ///< Position of each node on the current walk, -1 if absent
+    vector<int> path;
+    vector<int> cycles, cycleStarts;            ///< Nodes of all AB-cycles and the offset of each
+    vector<int> order;
+    vector<int> label, componentSize, componentNode, members;
+};
+
+/**
+ * @brief Order crossover (OX) of two tours.
+ *
+ * The child keeps a random segment of parent A in place and takes the remaining nodes in the order
+ * in which they follow the segment in parent B. Only the order of the nodes is inherited, so it
+ * also suits asymmetric matrices.
+ *
+ * @param parentA The tour providing the segment, closed.
+ * @param parentB The tour providing the order of the other nodes, closed.
+ * @param n The number of nodes in the graph.
+ * @param gen The random number generator choosing the segment.
+ * @param used Scratch buffer of n flags.
+ * @param child Receives the child as a closed tour.
+ */
+template <typename Generator>
+void orderCrossover(const vector<int>& parentA, const vector<int>& parentB, int n, Generator& gen, vector<char>& used, vector<int>& child) {
+    int first = static_cast<int>(gen() % n), last = static_cast<int>(gen() % n);
+    if (first > last) swap(first, last);
+
+    child.resize(n + 1);
+    fill(used.begin(), used.end(), 0);
+    for (int i = first; i <= last; ++i) {
+        child[i] = parentA[i];
+        used[parentA[i]] = 1;
+    }
+    int position = (last + 1) % n;
+    for (int i = 0; i < n; ++i) {
+        int node = parentB[(last + 1 + i) % n];
+        if (used[node]) continue;
+        child[position] = node;
+        position = (position + 1) % n;
+    }
+    child[n] = child[0];
+}
+
+/**
+ * @brief Solves the TSP using a genetic algorithm.
+ *
+ * The population starts from random tours improved by 2-opt. In each generation the population is
+ * shuffled and every tour A is crossed with the next tour B: with EAX on symmetric matrices, or
+ * otherwise with OX followed by a random segment reversal (with probability mutationRate) and
+ * 2-opt. The child replaces A if it is shorter. The offspring of a generation are built in
+ * parallel into buffers allocated before the first generation, each pair drawing from its own
+ * Philox stream, so the result depends only on the seed.
+ *
+ * @param matrix A 2D matrix representing distances between nodes.
+ * @param n The number of nodes in the graph.
+ * @param parameters The population size, operators and stopping rules.
+ * @return A pair consisting of the best route found and its total duration.
+ * @note The run also stops when a generation replaces no tour, as the population has converged.
+ */
+pair<vector<int>, double> geneticAlgorithm(const MatrixView& matrix, int n, const GaParameters& parameters = GaParameters()) {
+    if (n <= 3) return bruteForce(matrix, n);
+
+    const int size = max(2, parameters.populationSize);
+    const int threads = max(1, min(parameters.numThreads, size));
+    vector<vector<int>> neighbours = buildCandidateLists(matrix, n, LOCAL_SEARCH_NEIGHBOURS);
+    auto start = chrono::steady_clock::now();
+
+    // Preallocated population, offspring and per-thread crossover buffers
+    vector<vector<int>> population(size, vector<int>(n + 1)), offspring(size, vector<int>(n + 1));
+    vector<double> lengths(size), offspringLengths(size);
+    vector<EdgeAssembly> assemblies;
+    for (int t = 0; parameters.symmetric && t < threads; ++t) assemblies.emplace_back(matrix, n, neighbours);
+    vector<vector<char>> used(threads, vector<char>(n));
+
+    auto parallel = [&](auto task) {
+        auto worker = [&](int first) {
+            for (int i = first; i < size; i += threads) task(first, i);
+        };
+        vector<thread> pool;
+        for (int t = 1; t < threads; ++t) pool.emplace_back(worker, t);
+        worker(0);
+        for (auto& t : pool) t.join();
+    };
+
+    parallel([&](int, int i) {
+        Philox4x32 gen(parameters.seed, 0, static_cast<uint32_t>(i));
+        vector<int>& route = population[i];
+        iota(route.begin(), route.end() - 1, 0);
+        shuffle(route.begin(), route.end() - 1, gen);
+        route[n] = route[0];
+        auto result = twoOpt(matrix, n, route, neighbours, parameters.symmetric);
+        route = move(result.first);
+        lengths[i] = result.second;
+    });
+
+    vector<int> order(size);
+    double bestLength = *min_element(lengths.begin(), lengths.end());
+    int lastImprovement = 0;
+    for (int generation = 1; generation <= parameters.numGenerations; ++generation) {
+        iota(order.begin(), order.end(), 0);
+        Philox4x32 shuffler(parameters.seed, static_cast<uint32_t>(generation), static_cast<uint32_t>(size));
+        shuffle(order.begin(), order.end(), shuffler);
+
+        parallel([&](int worker, int i) {
+            Philox4x32 gen(parameters.seed, static_cast<uint32_t>(generation), static_cast<uint32_t>(i));
+            const vector<int>& parentA = population[order[i]];
+            const vector<int>& parentB = population[order[(i + 1) % size]];
+            if (parameters.symmetric) {
+                offspringLengths[i] = assemblies[worker].cross(parentA, lengths[order[i]], parentB, parameters.numChildren, gen, offspring[i]);
+                return;
+            }
+
+            vector<int>& child = offspring[i];
+            orderCrossover(parentA, parentB, n, gen, used[worker], child);
+            if (uniform_real_distribution<double>(0.0, 1.0)(gen) < parameters.mutationRate) {
+                int first = static_cast<int>(gen() % n), last = static_cast<int>(gen() % n);
+                if (first > last) swap(first, last);
+                reverse(child.begin() + first, child.begin() + last + 1);
+                child[n] = child[0];
+            }
+            auto result = twoOpt(matrix, n, child, neighbours, false);
+            child = move(result.first);
+            offspringLengths[i] = result.second;
+        });
+
+        // Replace each parent A by its child if the child is shorter
+        bool replaced = false;
+        for (int i = 0; i < size; ++i) {
+            if (offspringLengths[i] < lengths[order[i]] - 1e-9) {
+                swap(population[order[i]], offspring[i]);
+                lengths[order[i]] = offspringLengths[i];
+                replaced = true;
+            }
+        }
+
+        double generationBest = *min_element(lengths.begin(), lengths.end());
+        if (generationBest < bestLength) {
+            bestLength = generationBest;
+            lastImprovement = generation;
+        }
+        if (!replaced) break;
+        if (parameters.stagnationGenerations > 0 && generation - lastImprovement >= parameters.stagnationGenerations) break;
+        if (parameters.timeLimit > 0 && chrono::duration<double>(chrono::steady_clock::now() - start).count() >= parameters.timeLimit) break;
+    }
+
+    int best = static_cast<int>(min_element(lengths.begin(), lengths.end()) - lengths.begin());
+    vector<int> bestRoute = rotateToDepot(population[best]);
+    return {bestRoute, calculateTotalDuration(bestRoute, matrix)};
+}
+
+/**
+ * @brief Computes min_j (a[j] + b[j]).
+ *
+ * The inner step of Held-Karp: a is the predecessor row of the DP table and b the transposed
+ * matrix column, so absent predecessors (infinite DP entries) drop out without any branching.
+ * With AVX four lanes are reduced at a time.
+ *
+ * @param a The first operand; length entries.
+ * @param b The second operand; length entries.
+ * @param length The number of entries, a multiple of 4.
+ * @return The minimum sum.
+ */
+inline double minPlus(const double* a, const double* b, int length) {
+#if defined(__AVX__)
+    __m256d best = _mm256_set1_pd(HUGE_VAL);
+    for (int j = 0; j < length; j += 4) {
+        best = _mm256_min_pd(best, _mm256_add_pd(_mm256_loadu_pd(a + j), _mm256_loadu_pd(b + j)));
+    }
+    __m128d half = _mm_min_pd(_mm256_castpd256_pd128(best), _mm256_extractf128_pd(best, 1));
+    half = _mm_min_sd(half, _mm_unpackhi_pd(half, half));
+    return _mm_cvtsd_f64(half);
+#else
+    double minimum = HUGE_VAL;
+    for (int j = 0; j < length; ++j) {
+        minimum = min(minimum, a[j] + b[j]);
+    }
+    return minimum;
+#endif
+}
+
+/**
+ * @brief Returns the index attaining min_j (a[j] + b[j]), the lowest one on ties.
+ * @param a The first operand; length entries.
+ * @param b The second operand; length entries.
+ * @param length The number of entries.
+ * @return The index of the minimum, or -1 if every sum is infinite.
+ */
+inline int argminPlus(const double* a, const double* b, int length) {
+    double minimum = HUGE_VAL;
+    int argmin = -1;
+    for (int j = 0; j < length; ++j) {
+        if (a[j] + b[j] < minimum) {
+            minimum = a[j] + b[j];
+            argmin = j;
+        }
+    }
+    return argmin;
+}
+
+/**
+ * @brief Solves the TSP using the Held-Karp dynamic programming algorithm.
+ *
+ * Subsets cover the nodes other than the starting node, which is only the implicit start and end
+ * of every path. The DP table is stored flat with rows padded to a multiple of 4 and unreached
+ * entries set to infinity, and the matrix is stored transposed, so the minimisation over
+ * predecessors is one contiguous min-plus reduction per entry (see minPlus). No parent table is
+ * kept: the argmin is recomputed for the n entries on the optimal path while backtracking.
+ * Instances of up to SMALL_EXACT_MAX nodes are dispatched to the stack-resident heldKarpSmall.
+ *
+ * @param matrix A 2D matrix representing distances between nodes.
+ * @param n The number of nodes in the graph.
+ * @return A pair consisting of the optimal route and its total duration.
+ */
+pair<vector<int>, double> heldKarp(const MatrixView& matrix, int n) {
+    if (n <= SMALL_EXACT_MAX && SMALL_EXACT_SOLVERS[n].heldKarp != nullptr) {
+        return SMALL_EXACT_SOLVERS[n].heldKarp(matrix);
+    }
+    if (n <= 2) {
+        vector<int> route = {0};
+        if (n == 2) route.push_back(1);
+        route.push_back(0);
+        return {route, calculateTotalDuration(route, matrix)};
+    }
+
+    int m = n - 1;                    ///< Nodes besides the starting node; node v is bit v - 1
+    int stride = (m + 3) / 4 * 4;     ///< Row length padded for the vector kernel
+    size_t subsets = size_t(1) << m;
+    vector<double> dp(subsets * stride, HUGE_VAL); ///< DP table, row per subset
+    vector<double> transposed(static_cast<size_t>(m) * stride, HUGE_VAL); ///< transposed[i][j] = matrix[j][i]
+    for (int i = 0; i < m; ++i) {
+        for (int j = 0; j < m; ++j) {
+            transposed[i * stride + j] = (i == j) ? HUGE_VAL : matrix[j + 1][i + 1];
+        }
+    }
+
+    // Base case: direct paths from the starting node
+    for (int i = 0; i < m; ++i) {
+        dp[(size_t(1) << i) * stride + i] = matrix[0][i + 1];
+    }
+
+    // Fill the DP table
+    for (size_t mask = 1; mask < subsets; ++mask) {
+        if ((mask & (mask - 1)) == 0) continue; // Single nodes are the base case
+        for (int i = 0; i < m; ++i) {
+            if (!(mask & (size_t(1) << i))) continue;
+            const double* previous = dp.data() + (mask ^ (size_t(1) << i)) * stride;
+            dp[mask * stride + i] = minPlus(previous, transposed.data() + static_cast<size_t>(i) * stride, stride);
+        }
+    }
+
+    // Find the minimum route
+    size_t full = subsets - 1;
+    int last = -1;
+    double minDuration = DBL_MAX;
+    for (int i = 0; i < m; ++i) {
+        if (dp[full * stride + i] + matrix[i + 1][0] < minDuration) {
+            minDuration = dp[full * stride + i] + matrix[i + 1][0];
+            last = i;
+        }
+    }
+
+    // Backtrack to find the optimal route
+    vector<int> route = {0}; // Return to the start
+    size_t mask = full;
+    while (mask != 0) {
+        route.push_back(last + 1);
+        mask ^= size_t(1) << last;
+        last = argminPlus(dp.data() + mask * stride, transposed.data() + static_cast<size_t>(last) * stride, m);
+    }
+    route.push_back(0); // Add the starting node
+    reverse(route.begin(), route.end());
+
+    return {route, minDuration};
+}
+
+/**
+ * @brief Computes the binomial coefficients C(a, b) for 0 <= a, b <= size.
+ * @param size The largest value of a.
+ * @return The table indexed as [a][b].
+ */
+vector<vector<uint64_t>> binomialTable(int size) {
+    vector<vector<uint64_t>> binomial(size + 1, vector<uint64_t>(size + 1, 0));
+    for (int a = 0; a <= size; ++a) {
+        binomial[a][0] = 1;
+        for (int b = 1; b <= a; ++b) {
+            binomial[a][b] = binomial[a - 1][b - 1] + binomial[a - 1][b];
+        }
+    }
+    return binomial;
+}
+
+/**
+ * @brief Ranks a subset among the subsets of the same size (combinatorial number system).
+ * @param mask The subset as a bit mask.
+ * @param binomial The binomial table from binomialTable.
+ * @return The colexicographic rank of the subset.
+ */
+uint64_t subsetRank(uint32_t mask, const vector<vector<uint64_t>>& binomial) {
+    uint64_t rank = 0;
+    int index = 1;
+    for (int element = 0; element < 32; ++element) {
+        if (mask & (1u << element)) rank += binomial[element][index++];
+    }
+    return rank;
+}
+
+/**
+ * @brief Returns the subset of the given size with the given colexicographic rank.
+ * @param rank The rank of the subset.
+ * @param k The size of the subset.
+ * @param binomial The binomial table from binomialTable.
+ * @return The subset as a bit mask.
+ */
+uint32_t subsetUnrank(uint64_t rank, int k, const vector<vector<uint64_t>>& binomial) {
+    uint32_t mask = 0;
+    int element = static_cast<int>(binomial.size()) - 1;
+    for (int index = k; index >= 1; --index) {
+        while (binomial[element][index] > rank) --element;
+        rank -= binomial[element][index];
+        mask |= 1u << element;
+        --element;
+    }
+    return mask;
+}
+
+/**
+ * @brief Computes one cardinality layer of the Held-Karp recursion from the previous one.
+ *
+ * Node v >= 1 is bit v - 1 of a subset. Layer k stores, for every k-subset S (by rank) and every
+ * end node at position p of S, the cheapest path from node 0 through S ending at that node:
+ * entry [rank(S) * k + p]. The predecessor layer entry is found by ranking S without the end node.
+ *
+ * @param matrix A 2D matrix representing distances between nodes.
+ * @param m The number of nodes besides node 0.
+ * @param k The size of the subsets in the layer to compute (at least 2).
+ * @param previous The layer of size k - 1.
+ * @param current Receives the layer of size k.
+ * @param parent Receives the predecessor node of every entry.
+ * @param binomial The binomial table from binomialTable.
+ * @param numThreads The number of threads to split the subsets over.
+ * @param reversed Whether to build paths towards node 0 instead of away from it (edges reversed).
+ * @tparam Cost The type the layers store costs in; each step is summed in double before storing.
+ */
+template <typename Cost>
+void heldKarpLayer(const MatrixView& matrix, int m, int k, const vector<Cost>& previous, vector<Cost>& current,
+                   vector<uint8_t>& parent, const vector<vector<uint64_t>>& binomial, int numThreads, bool reversed = false) {
+    uint64_t count = binomial[m][k];
+    current.resize(count * k); // Every entry is written below
+    parent.resize(count * k);
+
+    auto worker = [&](uint64_t lo, uint64_t hi) {
+        int elements[32];
+        uint64_t prefix[33], suffix[33];
+        uint32_t mask = subsetUnrank(lo, k, binomial);
+        for (uint64_t rank = lo; rank < hi; ++rank) {
+            for (int bit = 0, index = 0; index < k; ++bit) {
+                if (mask & (1u << bit)) elements[index++] = bit;
+            }
+            // rank(S without element p) = sum_{t<p} C(e_t, t+1) + sum_{t>p} C(e_t, t)
+            prefix[0] = 0;
+            for (int t = 0; t < k; ++t) prefix[t + 1] = prefix[t] + binomial[elements[t]][t + 1];
+            suffix[k] = 0;
+            for (int t = k - 1; t >= 0; --t) suffix[t] = suffix[t + 1] + binomial[elements[t]][t];
+
+            for (int p = 0; p < k; ++p) {
+                const Cost* costs = previous.data() + (prefix[p] + suffix[p + 1]) * (k - 1);
+                int to = elements[p] + 1;
+                double best = DBL_MAX;
+                int bestFrom = -1;
+                for (int q = 0; q < k; ++q) {
+                    if (q == p) continue;
+                    int from = elements[q] + 1;
+                    double candidate = costs[q < p ? q : q - 1] + (reversed ? matrix[to][from] : matrix[from][to]);
+                    if (candidate < best) {
+                        best = candidate;
+                        bestFrom = from;
+                    }
+                }
+                current[rank * k + p] = static_cast<Cost>(best);
+                parent[rank * k + p] = static_cast<uint8_t>(bestFrom);
+            }
+
+            // Next subset of the same size in colexicographic order (Gosper's hack)
+            uint32_t lowest = mask & (~mask + 1);
+            uint32_t ripple = mask + lowest;
+            mask = (((ripple ^ mask) >> 2) / lowest) | ripple;
+        }
+    };
+
+    int threads = static_cast<int>(min<uint64_t>(max(1, numThreads), max<uint64_t>(1, count / 1024)));
+    vector<thread> pool;
+    for (int t = 1; t < threads; ++t) {
+        pool.emplace_back(worker, count * t / threads, count * (t + 1) / threads);
+    }
+    worker(0, count / threads);
+    for (auto& t : pool) t.join();
+}
+
+const int LAYERED_HELD_KARP_MAX_NODES = 32; ///< Subsets of the layered Held-Karp variants are 32-bit masks
+
+/**
+ * @brief Solves the TSP exactly with Held-Karp, keeping only two cardinality layers in memory.
+ *
+ * Layer k of the recursion only depends on layer k - 1, so the costs of older layers are dropped
+ * and only their parent pointers (one byte per entry) are written sequentially to a file, which is
+ * read back with n seeks to reconstruct the route. The two resident layers store their costs as
+ * floats; each step is summed in double, but paths whose costs differ by less than float precision
+ * (about 1e-7 relative) may be taken for one another. The returned duration is recomputed in double.
+ *
+ * Peak memory is two adjacent layers of C(n-1, k) * k floats plus one parent byte per entry of the
+ * newer one, instead of 2^n * n entries: about 10.2 GB at n = 30 (k = 14 and 15), with a parent file
+ * of (n-1) * 2^(n-2) bytes (7.8 GB). Both roughly double per added node (42 GB and 33 GB at n = 32).
+ *
+ * @param matrix A 2D matrix representing distances between nodes.
+ * @param n The number of nodes in the graph (at most LAYERED_HELD_KARP_MAX_NODES).
+ * @param parentFilename The file receiving the parent pointers; it is deleted afterwards.
+ * @param numThreads The number of threads used per layer.
+ * @return A pair consisting of the optimal route and its total duration.
+ */
+pair<vector<int>, double> heldKarpOutOfCore(const MatrixView& matrix, int n, const string& parentFilename = "held_karp_parents.tmp",
+                                            int numThreads = static_cast<int>(thread::hardware_concurrency())) {
+    if (n > LAYERED_HELD_KARP_MAX_NODES) {
+        cerr << "Error: Held-Karp supports at most " << LAYERED_HELD_KARP_MAX_NODES << " nodes!" << endl;
+        return {{}, DBL_MAX};
+    }
+    if (n <= 2) {
+        vector<int> route = {0};
+        if (n == 2) route.push_back(1);
+        route.push_back(0);
+        return {route, calculateTotalDuration(route, matrix)};
+    }
+
+    int m = n - 1; ///< Nodes besides the starting node
+    vector<vector<uint64_t>> binomial = binomialTable(m);
+    vector<uint64_t> layerOffset(m + 2, 0); ///< Position of each parent layer in the file
+    for (int k = 1; k <= m; ++k) {
+        layerOffset[k + 1] = layerOffset[k] + binomial[m][k] * k;
+    }
+
+    ofstream parentFile(parentFilename, ios::binary | ios::trunc);
+    if (!parentFile) {
+        cerr << "Error: Could not open " << parentFilename << " for writing!" << endl;
+        return {{}, DBL_MAX};
+    }
+
+    // Base case: direct paths from the starting node (the rank of {v} is v - 1)
+    vector<float> previous(m), current;
+    vector<uint8_t> parent(m, 0);
+    for (int v = 1; v < n; ++v) {
+        previous[v - 1] = matrix[0][v];
+    }
+    parentFile.write(reinterpret_cast<const char*>(parent.data()), static_cast<streamsize>(parent.size()));
+
+    for (int k = 2; k <= m; ++k) {
+        heldKarpLayer(matrix, m, k, previous, current, parent, binomial, numThreads);
+        parentFile.write(reinterpret_cast<const char*>(parent.data()), static_cast<streamsize>(parent.size()));
+        swap(previous, current);
+    }
+    parentFile.close();
+
+    // Close the tour from the layer containing every node
+    int last = -1;
+    double minDuration = DBL_MAX;
+    for (int p = 0; p < m; ++p) {
+        if (previous[p] + matrix[p + 1][0] < minDuration) {
+            minDuration = previous[p] + matrix[p + 1][0];
+            last = p + 1;
+        }
+    }
+    vector<float>().swap(previous);
+
+    // Backtrack through the parent layers on disk
+    ifstream parents(parentFilename, ios::binary);
+    vector<int> route;
+    uint32_t mask = (1u << m) - 1;
+    for (int k = m; k >= 1 && last > 0; --k) {
+        route.push_back(last);
+        uint32_t bit = 1u << (last - 1);
+        int position = static_cast<int>(bitset<32>(mask & (bit - 1)).count());
+        char byte;
+        parents.seekg(static_cast<streamoff>(layerOffset[k] + subsetRank(mask, binomial) * k + position));
+        parents.read(&byte, 1);
+        mask ^= bit;
+        last = static_cast<uint8_t>(byte);
+    }
+    parents.close();
+    remove(parentFilename.c_str());
+
+    route.push_back(0); // Add the starting node
+    reverse(route.begin(), route.end());
+    route.push_back(0); // Return to the start
+    return {route, calculateTotalDuration(route, matrix)};
 }
 
 /**
- * @brief Solves the TSP using the Nearest Neighbor algorithm.
+ * @brief Solves the TSP exactly with a bidirectional (meet-in-the-middle) Held-Karp recursion.
+ *
+ * Paths leaving node 0 are grown forward through subsets of up to ceil((n-1)/2) nodes and paths
+ * returning to node 0 are grown backward through the complementary subsets. Every tour is a
+ * forward half joined by one edge to the backward half over the complement, so the optimum is the
+ * cheapest such join. Only the two final half layers keep their costs; the join is split over threads.
+ *
  * @param matrix A 2D matrix representing distances between nodes.
- * @param n The number of nodes in the graph.
+ * @param n The number of nodes in the graph (at most LAYERED_HELD_KARP_MAX_NODES).
+ * @param numThreads The number of threads used per layer and for the join.
  * @return A pair consisting of the optimal route and its total duration.
  */
-pair<vector<int>, double> nearestNeighbour(const vector<vector<double>>& matrix, int n) {
-    vector<bool> visited(n, false); ///< Tracks visited nodes
-    vector<int> route = {0};        ///< Start from the first node
-    visited[0] = true;
-    double total = 0;
+pair<vector<int>, double> heldKarpBidirectional(const MatrixView& matrix, int n, int numThreads = static_cast<int>(thread::hardware_concurrency())) {
+    if (n > LAYERED_HELD_KARP_MAX_NODES) {
+        cerr << "Error: Held-Karp supports at most " << LAYERED_HELD_KARP_MAX_NODES << " nodes!" << endl;
+        return {{}, DBL_MAX};
+    }
+    if (n <= 3) return bruteForce(matrix, n);
 
-    for (int step = 0; step < n - 1; ++step) {
-        int current = route.back(); ///< Current location
-        double minDuration = DBL_MAX;
-        int nextLocation = -1;
+    int m = n - 1;                      ///< Nodes besides the starting node
+    int forwardSize = (m + 1) / 2;      ///< Nodes covered by the forward half
+    int backwardSize = m - forwardSize; ///< Nodes covered by the backward half
+    vector<vector<uint64_t>> binomial = binomialTable(m);
 
-        // Find the nearest unvisited neighbor
-        for (int i = 0; i < n; ++i) {
-            if (!visited[i] && matrix[current][i] < minDuration) {
-                minDuration = matrix[current][i];
-                nextLocation = i;
+    // Grows one direction up to the given subset size, keeping every parent layer
+    auto grow = [&](int size, bool reversed, vector<double>& costs, vector<vector<uint8_t>>& parents) {
+        parents.assign(size + 1, {});
+        costs.resize(m);
+        parents[1].assign(m, 0);
+        for (int v = 1; v < n; ++v) {
+            costs[v - 1] = reversed ? matrix[v][0] : matrix[0][v];
+        }
+        vector<double> next;
+        for (int k = 2; k <= size; ++k) {
+            heldKarpLayer(matrix, m, k, costs, next, parents[k], binomial, numThreads, reversed);
+            swap(costs, next);
+        }
+    };
+
+    vector<double> forward, backward;
+    vector<vector<uint8_t>> forwardParents, backwardParents;
+    grow(forwardSize, false, forward, forwardParents);
+    grow(backwardSize, true, backward, backwardParents);
+
+    // Join every forward subset with its complement
+    uint32_t full = (1u << m) - 1;
+    uint64_t count = binomial[m][forwardSize];
+    struct Join {
+        double cost = DBL_MAX;
+        uint32_t mask = 0;
+        int from = -1, to = -1;
+    };
+
+    auto worker = [&](uint64_t lo, uint64_t hi, Join& best) {
+        uint32_t mask = subsetUnrank(lo, forwardSize, binomial);
+        int inside[32], outside[32];
+        for (uint64_t rank = lo; rank < hi; ++rank) {
+            int a = 0, b = 0;
+            for (int bit = 0; bit < m; ++bit) {
+                if (mask & (1u << bit)) inside[a++] = bit + 1;
+                else outside[b++] = bit + 1;
+            }
+            const double* head = forward.data() + rank * forwardSize;
+            const double* tail = backward.data() + subsetRank(full ^ mask, binomial) * backwardSize;
+            for (int p = 0; p < forwardSize; ++p) {
+                for (int q = 0; q < backwardSize; ++q) {
+                    double cost = head[p] + matrix[inside[p]][outside[q]] + tail[q];
+                    if (cost < best.cost) best = {cost, mask, inside[p], outside[q]};
+                }
             }
+            uint32_t lowest = mask & (~mask + 1);
+            uint32_t ripple = mask + lowest;
+            mask = (((ripple ^ mask) >> 2) / lowest) | ripple;
         }
+    };
 
-        route.push_back(nextLocation);
-        visited[nextLocation] = true;
-        total += minDuration;
+    int threads = static_cast<int>(min<uint64_t>(max(1, numThreads), max<uint64_t>(1, count / 1024)));
+    vector<Join> results(threads);
+    vector<thread> pool;
+    for (int t = 1; t < threads; ++t) {
+        pool.emplace_back(worker, count * t / threads, count * (t + 1) / threads, ref(results[t]));
+    }
+    worker(0, count / threads, results[0]);
+    for (auto& t : pool) t.join();
+    Join best;
+    for (const auto& result : results) {
+        if (result.cost < best.cost) best = result;
     }
 
-    // Add the distance back to the starting point
-    total += matrix[route.back()][0];
-    route.push_back(0); // Complete the route by returning to the start
-    return {route, total};
+    // Backtrack the forward half from its last node back to node 0
+    auto follow = [&](uint32_t mask, int node, int size, const vector<vector<uint8_t>>& parents) {
+        vector<int> path;
+        for (int k = size; k >= 1; --k) {
+            path.push_back(node);
+            uint32_t bit = 1u << (node - 1);
+            int position = static_cast<int>(bitset<32>(mask & (bit - 1)).count());
+            int previous = parents[k][subsetRank(mask, binomial) * k + position];
+            mask ^= bit;
+            node = previous;
+        }
+        return path;
+    };
+
+    vector<int> route = follow(best.mask, best.from, forwardSize, forwardParents);
+    route.push_back(0);
+    reverse(route.begin(), route.end());
+    vector<int> tail = follow(full ^ best.mask, best.to, backwardSize, backwardParents);
+    route.insert(route.end(), tail.begin(), tail.end());
+    route.push_back(0); // Return to the start
+    return {route, best.cost};
 }
 
 /**
- * @brief Solves the TSP using a brute force approach.
+ * @brief Reusable barrier for threads that synchronise thousands of times per second.
+ */
+class SpinBarrier {
+public:
+    explicit SpinBarrier(int count) : count(count) {}
+
+    /**
+     * @brief Blocks until all threads have called wait for the current round.
+     */
+    void wait() {
+        int round = generation.load(memory_order_acquire);
+        if (waiting.fetch_add(1, memory_order_acq_rel) + 1 == count) {
+            waiting.store(0, memory_order_relaxed);
+            generation.fetch_add(1, memory_order_release);
+        } else {
+            while (generation.load(memory_order_acquire) == round) this_thread::yield();
+        }
+    }
+
+private:
+    const int count;           ///< Number of participating threads
+    atomic<int> waiting{0};    ///< Threads that arrived in the current round
+    atomic<int> generation{0}; ///< Completed rounds
+};
+
+/**
+ * @brief Checks whether a matrix is symmetric.
  * @param matrix A 2D matrix representing distances between nodes.
  * @param n The number of nodes in the graph.
- * @return A pair consisting of the optimal route and its total duration.
+ * @return True if matrix[i][j] == matrix[j][i] for every pair.
  */
-pair<vector<int>, double> bruteForce(const vector<vector<double>>& matrix, int n) {
-    vector<int> locations(n - 1);
-    iota(locations.begin(), locations.end(), 1); // Generate {1, 2, ..., n-1}
+bool isSymmetric(const MatrixView& matrix, int n) {
+    for (int i = 0; i < n; ++i) {
+        for (int j = i + 1; j < n; ++j) {
+            if (matrix[i][j] != matrix[j][i]) return false;
+        }
+    }
+    return true;
+}
 
-    double minDuration = DBL_MAX;
-    vector<int> optimalRoute;
+/**
+ * @brief Parameters of simulated annealing and parallel tempering.
+ */
+struct SaParameters {
+    int numSweeps = 1000;                ///< Sweeps of n proposed moves per replica
+    double initialAcceptance = 0.3;      ///< Probability of accepting an average uphill move at the start temperature
+    double finalTemperatureRatio = 1e-3; ///< Ratio of the final (coldest) temperature to the start (hottest) one
+    int numReplicas = 1;                 ///< 1 anneals a single tour; more run parallel tempering, one thread each
+    int exchangeInterval = 10;           ///< Parallel tempering: sweeps between attempted swaps of temperatures
+    bool symmetric = false;              ///< Whether 2-opt and reversed segment insertions may be used
+    uint64_t seed = random_device{}();   ///< Seed of the random number streams; equal seeds give equal results
+    double timeLimit = 0.0;              ///< Run for this many seconds instead of numSweeps sweeps, 0 to disable
+};
 
-    do {
-        vector<int> route = {0}; // Start at the first node
-        route.insert(route.end(), locations.begin(), locations.end());
-        route.push_back(0); // Return to the start
+/**
+ * @brief One Markov chain of simulated annealing on an array tour.
+ *
+ * A move starts at a random node and pairs it with one of its nearest neighbours, so most
+ * proposals are plausible. Two kinds are proposed: 2-opt, joining the node to the neighbour by
+ * reversing a path (symmetric matrices only), and or-opt, moving a segment of 1 to 3 nodes next to
+ * the neighbour, reversed or not. The change in length of either takes O(1) matrix lookups; on
+ * asymmetric matrices segments are only moved in their own direction, which keeps it exact.
+ */
+class AnnealingChain {
+public:
+    /**
+     * @brief Creates a chain at the given tour.
+     * @param matrix A 2D matrix representing distances between nodes.
+     * @param n The number of nodes in the graph.
+     * @param neighbours The candidate lists the moves are drawn from.
+     * @param symmetric Whether the matrix is symmetric.
+     * @param initial The starting tour, closed, and its total duration.
+     * @param seed The seed of the run.
+     * @param stream The random number stream of this chain.
+     */
+    AnnealingChain(const MatrixView& matrix, int n, const vector<vector<int>>& neighbours, bool symmetric,
+                   const pair<vector<int>, double>& initial, uint64_t seed, uint32_t stream)
+        : matrix(matrix), n(n), neighbours(neighbours), symmetric(symmetric), tour(initial.first, symmetric),
+          gen(seed, stream), currentLength(initial.second), bestRoute(initial.first), bestLength(initial.second) {}
 
-        double duration = calculateTotalDuration(route, matrix);
-        if (duration < minDuration) {
-            minDuration = duration;
-            optimalRoute = route;
+    /**
+     * @brief Estimates a start temperature at which an average uphill move is accepted with the given probability.
+     */
+    double startTemperature(double acceptance) {
+        double uphill = 0.0;
+        int count = 0;
+        for (int k = 0; k < 1000; ++k) {
+            double delta = propose();
+            if (delta != DBL_MAX && delta > 0) {
+                uphill += delta;
+                ++count;
+            }
         }
-    } while (next_permutation(locations.begin(), locations.end())); // Try all permutations
+        return count > 0 ? -(uphill / count) / log(acceptance) : 1.0;
+    }
 
-    return {optimalRoute, minDuration};
-}
+    /**
+     * @brief Proposes n moves with the Metropolis rule and records the tour if it is the best so far.
+     * @param temperature The temperature of the sweep.
+     */
+    void sweep(double temperature) {
+        uniform_real_distribution<double> uniform(0.0, 1.0);
+        for (int k = 0; k < n; ++k) {
+            double delta = propose();
+            if (delta == DBL_MAX) continue;
+            if (delta <= 0 || uniform(gen) < exp(-delta / temperature)) {
+                apply();
+                currentLength += delta;
+            }
+        }
+
+        // Recompute the length so that rounding errors do not accumulate
+        currentLength = 0.0;
+        for (int node = 0, k = 0; k < n; ++k, node = tour.next(node)) currentLength += matrix[node][tour.next(node)];
+        if (currentLength < bestLength) {
+            bestLength = currentLength;
+            bestRoute = tour.route(0);
+        }
+    }
+
+    double length() const { return currentLength; }
+    const vector<int>& best() const { return bestRoute; }
+    double bestTourLength() const { return bestLength; }
+
+private:
+    /**
+     * @brief Draws a move and returns its change in length, or DBL_MAX if the move is not valid.
+     */
+    double propose() {
+        const int a = static_cast<int>(gen() % n);
+        const vector<int>& candidates = neighbours[a];
+        const int c = candidates[gen() % candidates.size()];
+
+        if (symmetric && (gen() & 1)) {
+            // 2-opt: either a -> b, c -> d become a -> c, b -> d, or pa -> a, pc -> c become pa -> pc, a -> c
+            twoOptMove = true;
+            if (gen() & 1) {
+                int b = tour.next(a), d = tour.next(c);
+                if (c == b || d == a) return DBL_MAX;
+                first = b, last = c;
+                return matrix[a][c] + matrix[b][d] - matrix[a][b] - matrix[c][d];
+            }
+            int pa = tour.prev(a), pc = tour.prev(c);
+            if (c == pa || pc == a) return DBL_MAX;
+            first = a, last = pc;
+            return matrix[pa][pc] + matrix[a][c] - matrix[pa][a] - matrix[pc][c];
+        }
+
+        // Or-opt: the segment starting at a moves next to c, between after and its successor
+        twoOptMove = false;
+        const int length = 1 + static_cast<int>(gen() % 3);
+        first = last = a;
+        for (int k = 1; k < length; ++k) last = tour.next(last);
+        reversed = symmetric && (gen() & 1);
+        after = reversed ? tour.prev(c) : c;
+        const int before = tour.next(after);
+        if (tour.between(first, after, last) || tour.between(first, before, last)) return DBL_MAX;
+
+        const int p = tour.prev(first), q = tour.next(last);
+        double delta = matrix[p][q] - matrix[p][first] - matrix[last][q] - matrix[after][before];
+        return delta + (reversed ? matrix[after][last] + matrix[first][before] : matrix[after][first] + matrix[last][before]);
+    }
+
+    /**
+     * @brief Applies the move drawn by the last call of propose.
+     */
+    void apply() {
+        if (twoOptMove) tour.reverse(first, last);
+        else tour.moveSegment(first, last, after, reversed);
+    }
+
+    const MatrixView& matrix;
+    const int n;
+    const vector<vector<int>>& neighbours;
+    const bool symmetric;
+    ArrayTour tour;
+    Philox4x32 gen;
+    double currentLength;
+    vector<int> bestRoute;
+    double bestLength;
+
+    // The last proposed move
+    bool twoOptMove = false, reversed = false;
+    int first = 0, last = 0, after = 0;
+};
 
 /**
- * @brief Solves the TSP using the Ant Colony Optimization (ACO) algorithm.
+ * @brief Solves the TSP using simulated annealing, or parallel tempering with several replicas.
+ *
+ * All chains start from the nearest-neighbour tour. A single chain is cooled geometrically from a
+ * start temperature estimated from sampled uphill moves to finalTemperatureRatio times it, over
+ * numSweeps sweeps or over timeLimit seconds, so a time-limited run can be stopped at any time
+ * with a usable tour. With several replicas each runs on its own thread at a fixed temperature of
+ * a geometric ladder spanning the same range; every exchangeInterval sweeps the threads meet at a
+ * barrier and neighbouring temperatures are swapped between replicas with the parallel tempering
+ * acceptance probability, so good tours drift to the cold end while hot replicas keep exploring.
+ * Swapping temperatures instead of tours costs O(1).
+ *
  * @param matrix A 2D matrix representing distances between nodes.
  * @param n The number of nodes in the graph.
- * @param numAnts The number of ants to simulate.
- * @param numIterations The number of iterations to run the algorithm.
- * @param alpha The importance of pheromone strength in decision-making.
- * @param beta The importance of distance in decision-making.
- * @param evaporationRate The rate at which pheromones evaporate.
- * @return A pair consisting of the best route found and its total duration.
+ * @param parameters The schedule, number of replicas and stopping rule.
+ * @return A pair consisting of the best route found by any replica and its total duration.
+ * @note For equal seeds and no time limit the result does not depend on thread timing.
  */
-pair<vector<int>, double> antColonyOptimization(const vector<vector<double>>& matrix, int n, int numAnts = 100, int numIterations = 10, double alpha = 1.0, double beta = 2.0, double evaporationRate = 0.5) {
-    vector<vector<double>> pheromone(n, vector<double>(n, 1.0)); ///< Initial pheromone levels
-    vector<int> bestRoute;
-    double bestLength = DBL_MAX;
-
-    random_device rd;
-    mt19937 gen(rd()); ///< Random number generator
+pair<vector<int>, double> simulatedAnnealing(const MatrixView& matrix, int n, const SaParameters& parameters = SaParameters()) {
+    if (n <= 4) return bruteForce(matrix, n);
 
-    for (int iteration = 0; iteration < numIterations; ++iteration) {
-        vector<vector<int>> routes;    ///< Routes taken by ants
-        vector<double> routeLengths;  ///< Lengths of these routes
+    vector<vector<int>> neighbours = buildCandidateLists(matrix, n, LOCAL_SEARCH_NEIGHBOURS);
+    const auto initial = nearestNeighbour(matrix, n);
+    const int numReplicas = max(1, parameters.numReplicas);
+    auto start = chrono::steady_clock::now();
+    auto elapsed = [&]() { return chrono::duration<double>(chrono::steady_clock::now() - start).count(); };
 
-        for (int ant = 0; ant < numAnts; ++ant) {
-            vector<bool> visited(n, false);
-            vector<int> route;
-            int currentCity = gen() % n; // Random start city
+    vector<AnnealingChain> chains;
+    chains.reserve(numReplicas);
+    for (int r = 0; r < numReplicas; ++r) chains.emplace_back(matrix, n, neighbours, parameters.symmetric, initial, parameters.seed, static_cast<uint32_t>(r));
+    const double hottest = chains[0].startTemperature(parameters.initialAcceptance);
+    const double coldest = hottest * parameters.finalTemperatureRatio;
 
-            route.push_back(currentCity);
-            visited[currentCity] = true;
+    if (numReplicas == 1) {
+        for (int s = 0; parameters.timeLimit > 0 || s < parameters.numSweeps; ++s) {
+            double progress = parameters.timeLimit > 0 ? elapsed() / parameters.timeLimit : s / max(1.0, parameters.numSweeps - 1.0);
+            if (progress > 1.0) break;
+            chains[0].sweep(hottest * pow(parameters.finalTemperatureRatio, progress));
+        }
+    } else {
+        // ladder[k] is the replica at the k-th coldest temperature
+        vector<double> temperatures(numReplicas);
+        vector<int> ladder(numReplicas), rung(numReplicas);
+        for (int k = 0; k < numReplicas; ++k) {
+            temperatures[k] = coldest * pow(hottest / coldest, k / (numReplicas - 1.0));
+            ladder[k] = rung[k] = k;
+        }
 
-            for (int step = 0; step < n - 1; ++step) {
-                vector<double> probabilities(n, 0.0);
-                double total = 0.0;
+        const int interval = max(1, parameters.exchangeInterval);
+        const int numRounds = (parameters.numSweeps + interval - 1) / interval;
+        SpinBarrier barrier(numReplicas);
+        bool finished = false;
+        Philox4x32 exchanges(parameters.seed, static_cast<uint32_t>(numReplicas));
+        uniform_real_distribution<double> uniform(0.0, 1.0);
 
-                // Calculate probabilities based on pheromone and distance
-                for (int nextCity = 0; nextCity < n; ++nextCity) {
-                    if (!visited[nextCity]) {
-                        double tau = pow(pheromone[currentCity][nextCity], alpha);
-                        double eta = pow(1.0 / matrix[currentCity][nextCity], beta);
-                        probabilities[nextCity] = tau * eta;
-                        total += probabilities[nextCity];
+        auto runReplica = [&](int r) {
+            for (int round = 0; !finished; ++round) {
+                for (int s = 0; s < interval; ++s) chains[r].sweep(temperatures[rung[r]]);
+                barrier.wait();
+                if (r == 0) {
+                    for (int k = 0; k + 1 < numReplicas; ++k) {
+                        int cold = ladder[k], hot = ladder[k + 1];
+                        double exponent = (1 / temperatures[k] - 1 / temperatures[k + 1]) * (chains[cold].length() - chains[hot].length());
+                        if (exponent >= 0 || uniform(exchanges) < exp(exponent)) {
+                            swap(ladder[k], ladder[k + 1]);
+                            rung[ladder[k]] = k;
+                            rung[ladder[k + 1]] = k + 1;
+                        }
                     }
+                    finished = parameters.timeLimit > 0 ? elapsed() >= parameters.timeLimit : round + 1 >= numRounds;
                 }
+                barrier.wait();
+            }
+        };
 
-                for (double& p : probabilities) p /= total; // Normalize probabilities
+        vector<thread> pool;
+        for (int r = 1; r < numReplicas; ++r) pool.emplace_back(runReplica, r);
+        runReplica(0);
+        for (auto& t : pool) t.join();
+    }
 
-                // Choose the next city based on probabilities
-                discrete_distribution<int> dist(probabilities.begin(), probabilities.end());
-                int nextCity = dist(gen);
-                route.push_back(nextCity);
-                visited[nextCity] = true;
-                currentCity = nextCity;
-            }
+    int best = 0;
+    for (int r = 1; r < numReplicas; ++r) {
+        if (chains[r].bestTourLength() < chains[best].bestTourLength()) best = r;
+    }
+    return {chains[best].best(), calculateTotalDuration(chains[best].best(), matrix)};
+}
 
-            route.push_back(route[0]); // Return to start
-            double routeLength = calculateTotalDuration(route, matrix);
+/**
+ * @brief Computes a minimum penalised 1-tree on the dense matrix.
+ *
+ * Prim's algorithm grows the spanning tree on nodes 1..n-1 with the nodes split into one block per
+ * thread. After adding a node every thread updates the keys of its block and publishes the
+ * cheapest node of the block; all threads then pick the same next node from the published
+ * candidates, so they meet at a barrier once per added node. Node 0 is joined by its two cheapest
+ * penalised edges.
+ *
+ * @param matrix A symmetric 2D matrix representing distances between nodes.
+ * @param n The number of nodes in the graph (at least 3).
+ * @param penalty The penalty added to every edge at each node.
+ * @param numThreads The number of threads used on large instances.
+ * @param parentOf Receives the tree parent of every node 2..n-1 (node 1 is the root).
+ * @return The penalised cost of the 1-tree.
+ */
+double denseOneTree(const MatrixView& matrix, int n, const vector<double>& penalty, int numThreads, vector<int>& parentOf) {
+    int threads = n >= 2000 ? max(1, numThreads) : 1; ///< Barrier overhead outweighs the split on small trees
+    vector<double> key(n, DBL_MAX);
+    vector<char> inTree(n, 0);
+    parentOf.assign(n, -1);
+    vector<pair<double, int>> published(2 * threads); ///< Cheapest node of each block, double-buffered by step parity
+    double treeCost = 0;
 
-            // Update the best route
-            if (routeLength < bestLength) {
-                bestRoute = route;
-                bestLength = routeLength;
+    auto prim = [&](int id, SpinBarrier& barrier) {
+        int lo = 1 + (n - 1) * id / threads, hi = 1 + (n - 1) * (id + 1) / threads;
+        int picked = 1;
+        for (int step = 0; step < n - 2; ++step) {
+            // Only the owner of a node writes its entries, so the blocks are updated without locks
+            if (picked >= lo && picked < hi) inTree[picked] = 1;
+            const double* row = matrix[picked];
+            double penaltyPicked = penalty[picked];
+            pair<double, int> best = {DBL_MAX, -1};
+            for (int v = lo; v < hi; ++v) {
+                if (inTree[v]) continue;
+                double cost = row[v] + penaltyPicked + penalty[v];
+                if (cost < key[v]) {
+                    key[v] = cost;
+                    parentOf[v] = picked;
+                }
+                if (key[v] < best.first) best = {key[v], v};
+            }
+
+            pair<double, int>* slot = &published[(step & 1) * threads];
+            slot[id] = best;
+            barrier.wait();
+            pair<double, int> chosen = slot[0];
+            for (int t = 1; t < threads; ++t) {
+                if (slot[t].second != -1 && (chosen.second == -1 || slot[t].first < chosen.first)) chosen = slot[t];
             }
+            picked = chosen.second;
+            if (id == 0) treeCost += chosen.first;
+        }
+    };
+
+    SpinBarrier barrier(threads);
+    vector<thread> pool;
+    for (int t = 1; t < threads; ++t) pool.emplace_back(prim, t, ref(barrier));
+    prim(0, barrier);
+    for (auto& t : pool) t.join();
+
+    // Connect node 0 through its two cheapest penalised edges
+    double first = DBL_MAX, second = DBL_MAX;
+    for (int v = 1; v < n; ++v) {
+        double cost = matrix[0][v] + penalty[v];
+        if (cost < first) {
+            second = first;
+            first = cost;
+        } else if (cost < second) {
+            second = cost;
+        }
+    }
+    return treeCost + first + second + 2 * penalty[0];
+}
+
+/**
+ * @brief Computes the Held-Karp (Lagrangian 1-tree) lower bound for a symmetric TSP.
+ *
+ * A 1-tree is a spanning tree on nodes 1..n-1 plus the two cheapest edges at node 0; with node
+ * penalties pi added to every edge, its cost minus 2 * sum(pi) bounds every tour from below.
+ * Subgradient optimisation pushes the penalties towards a 1-tree in which every node has degree 2,
+ * using Polyak steps against the given upper bound; the step scale is halved whenever the bound
+ * stalls, and the search stops once it is negligible.
+ *
+ * The iterations run Prim's algorithm with a heap on a sparse graph: the nearest candidates of
+ * every node plus the edges of the given tour, which keep it connected. A tree of a subgraph may
+ * cost more than the minimum one, so the best penalties are certified by one dense 1-tree at the
+ * end and only that value is returned. At 10k nodes the whole bound costs about three passes over
+ * the matrix (candidate lists, certification and the tour itself).
+ *
+ * @param matrix A symmetric 2D matrix representing distances between nodes.
+ * @param n The number of nodes in the graph.
+ * @param tour Any closed route, e.g. from nearestNeighbour; its duration is the upper bound of the steps.
+ * @param numIterations The maximum number of subgradient iterations.
+ * @param numCandidates The number of nearest neighbours of every node kept in the sparse graph.
+ * @param numThreads The number of threads used by the dense 1-trees on large instances.
+ * @return The best lower bound found.
+ */
+double oneTreeLowerBound(const MatrixView& matrix, int n, const vector<int>& tour, int numIterations = 1000, int numCandidates = 10,
+                         int numThreads = static_cast<int>(thread::hardware_concurrency())) {
+    if (n < 3) return n == 2 ? matrix[0][1] + matrix[1][0] : 0.0;
+    double upperBound = calculateTotalDuration(tour, matrix);
 
-            routes.push_back(route);
-            routeLengths.push_back(routeLength);
+    // Sparse graph on nodes 1..n-1 in compressed rows
+    vector<vector<int>> candidates = buildCandidateLists(matrix, n, numCandidates);
+    vector<vector<int>> adjacent(n);
+    for (int v = 1; v < n; ++v) {
+        for (int w : candidates[v]) {
+            if (w == 0) continue;
+            adjacent[v].push_back(w);
+            adjacent[w].push_back(v);
+        }
+    }
+    for (size_t i = 0; i + 1 < tour.size(); ++i) {
+        int v = tour[i], w = tour[i + 1];
+        if (v == 0 || w == 0) continue;
+        adjacent[v].push_back(w);
+        adjacent[w].push_back(v);
+    }
+    vector<int> first(n + 1, 0), target;
+    vector<double> cost;
+    for (int v = 0; v < n; ++v) {
+        sort(adjacent[v].begin(), adjacent[v].end());
+        adjacent[v].erase(unique(adjacent[v].begin(), adjacent[v].end()), adjacent[v].end());
+        for (int w : adjacent[v]) {
+            target.push_back(w);
+            cost.push_back(matrix[v][w]);
         }
+        first[v + 1] = static_cast<int>(target.size());
+        vector<int>().swap(adjacent[v]);
+    }
 
-        // Evaporate pheromones
-        for (auto& row : pheromone) {
-            for (double& value : row) {
-                value *= (1 - evaporationRate);
+    vector<double> penalty(n, 0.0), key(n), bestPenalty = penalty;
+    vector<int> parentOf(n), degree(n);
+    vector<char> inTree(n);
+    priority_queue<pair<double, int>, vector<pair<double, int>>, greater<pair<double, int>>> heap;
+    double bestBound = -DBL_MAX;
+    double lambda = 2.0;       ///< Step size scale, halved when the bound stalls
+    int sinceImprovement = 0;
+    for (int iteration = 0; iteration < numIterations && lambda > 1e-3; ++iteration) {
+        fill(key.begin(), key.end(), DBL_MAX);
+        fill(inTree.begin(), inTree.end(), 0);
+        fill(degree.begin(), degree.end(), 0);
+        fill(parentOf.begin(), parentOf.end(), -1);
+        double treeCost = 0;
+        key[1] = 0;
+        heap.push({0.0, 1});
+        while (!heap.empty()) {
+            auto [distance, v] = heap.top();
+            heap.pop();
+            if (inTree[v]) continue;
+            inTree[v] = 1;
+            treeCost += distance;
+            if (parentOf[v] != -1) {
+                ++degree[v];
+                ++degree[parentOf[v]];
+            }
+            for (int e = first[v]; e < first[v + 1]; ++e) {
+                int w = target[e];
+                double edge = cost[e] + penalty[v] + penalty[w];
+                if (!inTree[w] && edge < key[w]) {
+                    key[w] = edge;
+                    parentOf[w] = v;
+                    heap.push({edge, w});
+                }
             }
         }
 
-        // Update pheromones based on routes
-        for (size_t i = 0; i < routes.size(); ++i) {
-            const auto& route = routes[i];
-            double routeLength = routeLengths[i];
-            for (size_t j = 0; j < route.size() - 1; ++j) {
-                pheromone[route[j]][route[j + 1]] += 1.0 / routeLength;
+        // Connect node 0 through its two cheapest penalised edges
+        int firstEdge = -1, secondEdge = -1;
+        for (int v = 1; v < n; ++v) {
+            double edge = matrix[0][v] + penalty[v];
+            if (firstEdge == -1 || edge < matrix[0][firstEdge] + penalty[firstEdge]) {
+                secondEdge = firstEdge;
+                firstEdge = v;
+            } else if (secondEdge == -1 || edge < matrix[0][secondEdge] + penalty[secondEdge]) {
+                secondEdge = v;
             }
         }
+        treeCost += matrix[0][firstEdge] + matrix[0][secondEdge] + 2 * penalty[0] + penalty[firstEdge] + penalty[secondEdge];
+        degree[0] = 2;
+        ++degree[firstEdge];
+        ++degree[secondEdge];
+
+        double bound = treeCost - 2 * accumulate(penalty.begin(), penalty.end(), 0.0);
+        if (bound > bestBound + 1e-9 * fabs(bestBound)) {
+            bestBound = bound;
+            bestPenalty = penalty;
+            sinceImprovement = 0;
+        } else if (++sinceImprovement >= 5) {
+            lambda /= 2;
+            sinceImprovement = 0;
+        }
+
+        double norm = 0;
+        for (int v = 0; v < n; ++v) norm += double(degree[v] - 2) * (degree[v] - 2);
+        if (norm == 0) break; // The 1-tree is a tour
+        double step = lambda * max(upperBound - bound, 1e-9 * fabs(upperBound)) / norm;
+        for (int v = 0; v < n; ++v) penalty[v] += step * (degree[v] - 2);
     }
 
-    return {bestRoute, bestLength};
+    return denseOneTree(matrix, n, bestPenalty, numThreads, parentOf) - 2 * accumulate(bestPenalty.begin(), bestPenalty.end(), 0.0);
 }
 
 /**
- * @brief Solves the TSP using the Held-Karp dynamic programming algorithm.
+ * @brief Solves the assignment problem on a matrix with the diagonal forbidden (Hungarian algorithm).
+ *
+ * Every tour is an assignment of successors, so the optimum is a lower bound for the asymmetric
+ * TSP. Runs in O(n^3) with dual potentials and shortest augmenting paths.
+ *
  * @param matrix A 2D matrix representing distances between nodes.
  * @param n The number of nodes in the graph.
- * @return A pair consisting of the optimal route and its total duration.
+ * @param successor Receives the node assigned as the successor of every node.
+ * @return The cost of the optimal assignment.
  */
-pair<vector<int>, double> heldKarp(const vector<vector<double>>& matrix, int n) {
-    vector<vector<int>> dp(1 << n, vector<int>(n, INT_MAX)); ///< DP table
-    vector<vector<int>> parent(1 << n, vector<int>(n, -1)); ///< Parent table for backtracking
+double solveAssignment(const MatrixView& matrix, int n, vector<int>& successor) {
+    successor.assign(n, -1);
+    if (n < 2) return 0.0;
 
-    // Base case: direct paths from the starting node
+    double forbidden = 1.0; ///< Finite cost of the diagonal, larger than any full assignment
     for (int i = 0; i < n; ++i) {
-        dp[1 << i][i] = matrix[0][i];
+        for (int j = 0; j < n; ++j) forbidden += fabs(matrix[i][j]);
     }
+    auto cost = [&](int i, int j) { return i == j ? forbidden : matrix[i][j]; };
 
-    // Fill the DP table
-    for (int mask = 1; mask < (1 << n); ++mask) {
-        for (int i = 0; i < n; ++i) {
-            if (mask & (1 << i)) {
-                for (int j = 0; j < n; ++j) {
-                    if (mask & (1 << j)) {
-                        if (dp[mask ^ (1 << i)][j] + matrix[j][i] < dp[mask][i]) {
-                            dp[mask][i] = dp[mask ^ (1 << i)][j] + matrix[j][i];
-                            parent[mask][i] = j;
-                        }
-                    }
+    // 1-based arrays: row[j] is the row assigned to column j, column 0 is the augmenting root
+    vector<double> u(n + 1, 0), v(n + 1, 0);
+    vector<int> row(n + 1, 0), way(n + 1, 0);
+    vector<double> minSlack(n + 1);
+    vector<char> used(n + 1);
+    for (int i = 1; i <= n; ++i) {
+        row[0] = i;
+        int column = 0;
+        fill(minSlack.begin(), minSlack.end(), DBL_MAX);
+        fill(used.begin(), used.end(), 0);
+        do {
+            used[column] = 1;
+            int current = row[column], nextColumn = 0;
+            double delta = DBL_MAX;
+            for (int j = 1; j <= n; ++j) {
+                if (used[j]) continue;
+                double slack = cost(current - 1, j - 1) - u[current] - v[j];
+                if (slack < minSlack[j]) {
+                    minSlack[j] = slack;
+                    way[j] = column;
+                }
+                if (minSlack[j] < delta) {
+                    delta = minSlack[j];
+                    nextColumn = j;
+                }
+            }
+            for (int j = 0; j <= n; ++j) {
+                if (used[j]) {
+                    u[row[j]] += delta;
+                    v[j] -= delta;
+                } else {
+                    minSlack[j] -= delta;
+                }
+            }
+            column = nextColumn;
+        } while (row[column] != 0);
+        do {
+            int previous = way[column];
+            row[column] = row[previous];
+            column = previous;
+        } while (column != 0);
+    }
+
+    double total = 0;
+    for (int j = 1; j <= n; ++j) {
+        successor[row[j] - 1] = j - 1;
+        total += cost(row[j] - 1, j - 1);
+    }
+    return total;
+}
+
+/**
+ * @brief Solves the asymmetric TSP with Karp's cycle-patching heuristic on the assignment solution.
+ *
+ * The optimal assignment is a set of disjoint cycles. Starting from the largest one, each remaining
+ * cycle (largest first) is patched in by exchanging one arc (a, a') of the tour so far and one arc
+ * (b, b') of the cycle for (a, b') and (b, a'), choosing the cheapest exchange. On random
+ * asymmetric matrices the assignment has few cycles and the result is usually close to optimal.
+ *
+ * @param matrix A 2D matrix representing distances between nodes.
+ * @param n The number of nodes in the graph.
+ * @return A pair consisting of the route and its total duration.
+ */
+pair<vector<int>, double> assignmentPatching(const MatrixView& matrix, int n) {
+    if (n <= 2) return bruteForce(matrix, n);
+
+    vector<int> successor;
+    solveAssignment(matrix, n, successor);
+
+    // Split the assignment into cycles, largest first
+    vector<vector<int>> cycles;
+    vector<char> seen(n, 0);
+    for (int start = 0; start < n; ++start) {
+        if (seen[start]) continue;
+        cycles.emplace_back();
+        for (int node = start; !seen[node]; node = successor[node]) {
+            seen[node] = 1;
+            cycles.back().push_back(node);
+        }
+    }
+    sort(cycles.begin(), cycles.end(), [](const vector<int>& a, const vector<int>& b) { return a.size() > b.size(); });
+
+    vector<int> tour = cycles[0]; ///< Nodes already patched into one cycle
+    for (size_t c = 1; c < cycles.size(); ++c) {
+        double bestDelta = DBL_MAX;
+        int bestA = -1, bestB = -1;
+        for (int a : tour) {
+            int nextA = successor[a];
+            for (int b : cycles[c]) {
+                int nextB = successor[b];
+                double delta = matrix[a][nextB] + matrix[b][nextA] - matrix[a][nextA] - matrix[b][nextB];
+                if (delta < bestDelta) {
+                    bestDelta = delta;
+                    bestA = a;
+                    bestB = b;
                 }
             }
         }
+        swap(successor[bestA], successor[bestB]);
+        tour.insert(tour.end(), cycles[c].begin(), cycles[c].end());
     }
 
-    // Find the minimum route
-    int last = -1;
-    double minDuration = DBL_MAX;
+    vector<int> route = {0};
+    for (int node = successor[0]; node != 0; node = successor[node]) route.push_back(node);
+    route.push_back(0);
+    return {route, calculateTotalDuration(route, matrix)};
+}
+
+/**
+ * @brief Computes the row and column reduction bound on the tour duration.
+ *
+ * Every node is left once and entered once, so the cheapest arc out of every node plus the
+ * cheapest remaining arc into every node after subtracting those bounds every tour. It is a
+ * feasible dual of the assignment problem, found in O(n^2) instead of O(n^3).
+ *
+ * @param matrix A 2D matrix representing distances between nodes.
+ * @param n The number of nodes in the graph.
+ * @return The lower bound.
+ */
+double reductionLowerBound(const MatrixView& matrix, int n) {
+    vector<double> rowMin(n, DBL_MAX), columnMin(n, DBL_MAX);
     for (int i = 0; i < n; ++i) {
-        if (dp[(1 << n) - 1][i] + matrix[i][0] < minDuration) {
-            minDuration = dp[(1 << n) - 1][i] + matrix[i][0];
-            last = i;
+        for (int j = 0; j < n; ++j) {
+            if (j != i) rowMin[i] = min(rowMin[i], matrix[i][j]);
+        }
+    }
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+            if (j != i) columnMin[j] = min(columnMin[j], matrix[i][j] - rowMin[i]);
         }
     }
+    return accumulate(rowMin.begin(), rowMin.end(), 0.0) + accumulate(columnMin.begin(), columnMin.end(), 0.0);
+}
 
-    // Backtrack to find the optimal route
-    vector<int> route;
-    int mask = (1 << n) - 1;
-    while (last != -1) {
-        route.push_back(last);
-        int newLast = parent[mask][last];
-        mask ^= (1 << last);
-        last = newLast;
+const int ASSIGNMENT_BOUND_MAX_NODES = 3000; ///< Largest matrix given the O(n^3) assignment bound (about 2 s)
+
+/**
+ * @brief Computes a lower bound on the optimal tour duration.
+ * @param matrix A 2D matrix representing distances between nodes.
+ * @param n The number of nodes in the graph (at least 2).
+ * @param method Receives the bound used: "1-tree" for symmetric matrices, "assignment" for asymmetric
+ *        ones up to ASSIGNMENT_BOUND_MAX_NODES nodes and "reduction" for larger asymmetric ones.
+ * @return The lower bound.
+ */
+double tourLowerBound(const MatrixView& matrix, int n, string& method) {
+    if (isSymmetric(matrix, n)) {
+        method = "1-tree";
+        return oneTreeLowerBound(matrix, n, nearestNeighbour(matrix, n).first);
     }
-    route.push_back(0); // Add the starting node
-    reverse(route.begin(), route.end());
+    if (n > ASSIGNMENT_BOUND_MAX_NODES) {
+        method = "reduction";
+        return reductionLowerBound(matrix, n);
+    }
+    method = "assignment";
+    vector<int> successor;
+    return solveAssignment(matrix, n, successor);
+}
 
-    return {route, minDuration};
+/**
+ * @brief Reads a distance matrix stored in the binary format written by build_matrix.
+ * @param filename The file holding an int32 size followed by the row-major float64 entries.
+ * @param matrix Receives the matrix.
+ * @return True if the file could be read, false otherwise.
+ */
+bool readBinaryMatrix(const string& filename, vector<vector<double>>& matrix) {
+    ifstream inputFile(filename, ios::binary);
+    if (!inputFile) return false;
+
+    int32_t size;
+    if (!inputFile.read(reinterpret_cast<char*>(&size), sizeof(size)) || size < 0) return false;
+    matrix.assign(size, vector<double>(size));
+    for (auto& row : matrix) {
+        if (!inputFile.read(reinterpret_cast<char*>(row.data()), static_cast<streamsize>(sizeof(double)) * size)) return false;
+    }
+    return true;
 }
 
+#ifndef TSP_NO_MAIN // Defined by tsp_native.cpp, which includes the solvers without the command-line driver
 /**
  * @brief Main function to read input data, execute TSP algorithms, and save results.
  * @return 0 on successful execution, non-zero on error.
  * @param argc The number of command-line arguments.
  * @param argv The command-line arguments.
- * @note The command-line argument is the number of files to process.
+ * @note The command-line arguments are the range of matrix files to process, optionally followed by
+ *       --algorithms and a comma-separated list of the algorithms to run instead of the default ones,
+ *       and by --seed and the seed of the randomised algorithms (recorded in the output; random if omitted).
+ *       --stagnation and --time-limit stop the ant colony and genetic algorithms after the given number of
+ *       iterations (generations) without improvement or the given number of seconds; with --time-limit
+ *       simulated annealing and parallel tempering run for that long. --local-search applies 2-opt to
+ *       every ant's tour (ant) or to the best tour of each iteration (best). --islands sets the number
+ *       of colonies of "Island MAX-MIN Ant System".
  */
 int main(int argc, char* argv[]) {
     string filename;
@@ -266,43 +4014,144 @@ int main(int argc, char* argv[]) {
     "Ant Colony Optimization", 
     "Held-Karp"
     }; ///< List of algorithms to run 
+    bool selected = false; ///< Whether the algorithms were chosen on the command line
+    random_device rd;
+    uint64_t seed = (static_cast<uint64_t>(rd()) << 32) | rd(); ///< Seed of the randomised algorithms
+    int stagnationIterations = 0; ///< Iterations (generations) without improvement after which the ant colonies and the GA stop
+    double timeLimit = 0.0;       ///< Time budget of each ant colony, GA or annealing run in seconds
+    LocalSearch localSearch = LocalSearch::None; ///< Tours the ant colonies improve with 2-opt
+    int numIslands = 0;           ///< Colonies of the island model, 0 for one per thread
     
-    if (argc != 3) {
-        cerr << "Usage: " << argv[0] << "<start> <end>" << endl;
+    if (argc < 3) {
+        cerr << "Usage: " << argv[0] << " <start> <end> [--algorithms <name,name,...>] [--seed <seed>] [--stagnation <iterations>] [--time-limit <seconds>] [--local-search <none|ant|best>] [--islands <count>]" << endl;
         return 1;
     }
 
     int end = std::stoi(argv[2]);
     int start = std::stoi(argv[1]);
 
-    for (int i = start; i < end+1; i++) {
-        filename = "data/matrix_" + to_string(i) + ".txt"; // Read the matrix from a file (from the "data" folder)
-        ifstream inputFile(filename);
-
-        if (!inputFile) {
-            cerr << "Error: File could not be opened!" << endl;
+    for (int a = 3; a < argc; ++a) {
+        string option = argv[a];
+        if (option == "--algorithms" && a + 1 < argc) {
+            algorithms.clear();
+            stringstream names(argv[++a]);
+            string name;
+            while (getline(names, name, ',')) algorithms.push_back(name);
+            selected = true;
+        } else if (option == "--seed" && a + 1 < argc) {
+            seed = stoull(argv[++a]);
+        } else if (option == "--stagnation" && a + 1 < argc) {
+            stagnationIterations = stoi(argv[++a]);
+        } else if (option == "--time-limit" && a + 1 < argc) {
+            timeLimit = stod(argv[++a]);
+        } else if (option == "--local-search" && a + 1 < argc) {
+            string mode = argv[++a];
+            if (mode == "ant") {
+                localSearch = LocalSearch::EveryAnt;
+            } else if (mode == "best") {
+                localSearch = LocalSearch::IterationBest;
+            } else if (mode != "none") {
+                cerr << "Error: Unknown local search " << mode << endl;
+                return 1;
+            }
+        } else if (option == "--islands" && a + 1 < argc) {
+            numIslands = stoi(argv[++a]);
+        } else {
+            cerr << "Error: Unknown option " << option << endl;
             return 1;
         }
+    }
 
-        cout << "Reading matrix from " << filename << endl;
+    cout << "Seed " << seed << endl;
 
-        // Read the matrix size
-        inputFile >> n;
-        vector<vector<double>> matrix(n, vector<double>(n));
+    for (int i = start; i < end+1; i++) {
+        vector<vector<double>> matrix;
+        filename = "data/matrix_" + to_string(i) + ".bin"; // Prefer the binary matrix written by build_matrix
+        if (readBinaryMatrix(filename, matrix)) {
+            cout << "Read matrix from " << filename << endl;
+            n = static_cast<int>(matrix.size());
+        } else {
+            filename = "data/matrix_" + to_string(i) + ".txt"; // Read the matrix from a file (from the "data" folder)
+            ifstream inputFile(filename);
 
-        // Read the matrix data
-        for (int i = 0; i < n; ++i) {
-            for (int j = 0; j < n; ++j) {
-                inputFile >> matrix[i][j];
+            if (!inputFile) {
+                cerr << "Error: File could not be opened!" << endl;
+                return 1;
+            }
+
+            cout << "Reading matrix from " << filename << endl;
+
+            // Read the matrix size
+            inputFile >> n;
+            matrix.assign(n, vector<double>(n));
+
+            // Read the matrix data
+            for (int i = 0; i < n; ++i) {
+                for (int j = 0; j < n; ++j) {
+                    inputFile >> matrix[i][j];
+                }
             }
+
+            inputFile.close();
+        }
+
+        // Coordinate-based algorithms only run when the coordinates of the nodes are available
+        vector<pair<double, double>> coordinates;
+        vector<string> fileAlgorithms = algorithms;
+        bool hasCoordinates = readCoordinates("data/coords_" + to_string(i) + ".txt", coordinates) && static_cast<int>(coordinates.size()) == n;
+        if (hasCoordinates && !selected) {
+            fileAlgorithms.push_back("Nearest Neighbor (k-d tree)");
+            fileAlgorithms.push_back("Greedy Edge");
         }
 
-        inputFile.close();
+        // Settings from the command line shared by the ant colony variants
+        auto acoParameters = [&](AcoParameters parameters) {
+            parameters.symmetric = isSymmetric(matrix, n);
+            parameters.seed = seed;
+            parameters.stagnationIterations = stagnationIterations;
+            parameters.timeLimit = timeLimit;
+            parameters.localSearch = localSearch;
+            parameters.numIslands = numIslands;
+            return parameters;
+        };
+        GaParameters gaParameters;
+        gaParameters.symmetric = isSymmetric(matrix, n);
+        gaParameters.seed = seed;
+        gaParameters.stagnationGenerations = stagnationIterations;
+        gaParameters.timeLimit = timeLimit;
+        SaParameters saParameters;
+        saParameters.symmetric = gaParameters.symmetric;
+        saParameters.seed = seed;
+        saParameters.timeLimit = timeLimit;
 
         json results;
+
+        // Lower bound on the optimal tour, used to report how far each result may be from optimal
+        double lowerBound = 0;
+        if (n >= 3) {
+            string method;
+            auto start = chrono::high_resolution_clock::now();
+            lowerBound = tourLowerBound(matrix, n, method);
+            auto end = chrono::high_resolution_clock::now();
+            auto duration = chrono::duration_cast<chrono::milliseconds>(end - start);
+            cout << "Lower bound (" << method << ") " << lowerBound << " computed in " << duration.count() << "ms" << endl;
+            results["lowerBound"] = {
+                {"value", lowerBound},
+                {"method", method},
+                {"time", duration.count()},
+            };
+        }
        
         // Execute each algorithm
-        for (const string& algorithm : algorithms) {
+        for (const string& algorithm : fileAlgorithms) {
+            if (!hasCoordinates && (algorithm == "Nearest Neighbor (k-d tree)" || algorithm == "Greedy Edge")) {
+                cerr << "Skipping " << algorithm << ": no coordinates for this matrix" << endl;
+                continue;
+            }
+            if (n > LAYERED_HELD_KARP_MAX_NODES && (algorithm == "Held-Karp (out-of-core)" || algorithm == "Held-Karp (bidirectional)")) {
+                cerr << "Skipping " << algorithm << ": at most " << LAYERED_HELD_KARP_MAX_NODES << " nodes are supported" << endl;
+                continue;
+            }
             auto start = chrono::high_resolution_clock::now();
 
             if (algorithm == "Nearest Neighbor") {
@@ -314,14 +4163,84 @@ int main(int argc, char* argv[]) {
                 auto result = bruteForce(matrix, n);
                 route = result.first;
                 length = result.second;
+            } else if (algorithm == "Brute Force (Heap's algorithm)") {
+                auto result = bruteForceHeap(matrix, n);
+                route = result.first;
+                length = result.second;
             } else if (algorithm == "Ant Colony Optimization") {
-                auto result = antColonyOptimization(matrix, n);
+                auto result = antColonyOptimization(matrix, n, acoParameters(AcoParameters()));
+                route = result.first;
+                length = result.second;
+            } else if (algorithm == "MAX-MIN Ant System") {
+                auto result = maxMinAntSystem(matrix, n, acoParameters(AcoParameters::maxMinDefaults()));
+                route = result.first;
+                length = result.second;
+            } else if (algorithm == "Island MAX-MIN Ant System") {
+                auto result = islandAntSystem(matrix, n, acoParameters(AcoParameters::maxMinDefaults()));
+                route = result.first;
+                length = result.second;
+            } else if (algorithm == "Ant Colony System") {
+                auto result = antColonySystem(matrix, n, acoParameters(AcoParameters::colonySystemDefaults()));
+                route = result.first;
+                length = result.second;
+            } else if (algorithm == "Genetic Algorithm") {
+                auto result = geneticAlgorithm(matrix, n, gaParameters);
+                route = result.first;
+                length = result.second;
+            } else if (algorithm == "Simulated Annealing") {
+                auto result = simulatedAnnealing(matrix, n, saParameters);
+                route = result.first;
+                length = result.second;
+            } else if (algorithm == "Parallel Tempering") {
+                SaParameters parameters = saParameters;
+                parameters.numReplicas = max(4, static_cast<int>(thread::hardware_concurrency()));
+                auto result = simulatedAnnealing(matrix, n, parameters);
                 route = result.first;
                 length = result.second;
             } else if (algorithm == "Held-Karp") {
                 auto result = heldKarp(matrix, n);
                 route = result.first;
                 length = result.second;
+            } else if (algorithm == "Held-Karp (out-of-core)") {
+                auto result = heldKarpOutOfCore(matrix, n, "output/held_karp_parents_" + to_string(i) + ".tmp");
+                route = result.first;
+                length = result.second;
+            } else if (algorithm == "Held-Karp (bidirectional)") {
+                auto result = heldKarpBidirectional(matrix, n);
+                route = result.first;
+                length = result.second;
+            } else if (algorithm == "Nearest Neighbor + Balas-Simonetti") {
+                auto initial = nearestNeighbour(matrix, n);
+                auto result = balasSimonetti(matrix, n, initial.first);
+                route = result.first;
+                length = result.second;
+            } else if (algorithm == "Nearest Neighbor + 2-opt") {
+                auto initial = nearestNeighbour(matrix, n);
+                auto result = twoOpt(matrix, n, initial.first, buildCandidateLists(matrix, n, LOCAL_SEARCH_NEIGHBOURS), isSymmetric(matrix, n));
+                route = result.first;
+                length = result.second;
+            } else if (algorithm == "Nearest Neighbor + 2-opt + Or-opt") {
+                auto candidates = buildCandidateLists(matrix, n, LOCAL_SEARCH_NEIGHBOURS);
+                bool symmetric = isSymmetric(matrix, n);
+                auto result = twoOpt(matrix, n, nearestNeighbour(matrix, n).first, candidates, symmetric);
+                result = orOpt(matrix, n, result.first, candidates, symmetric);
+                route = result.first;
+                length = result.second;
+            } else if (algorithm == "Assignment Patching") {
+                auto result = assignmentPatching(matrix, n);
+                route = result.first;
+                length = result.second;
+            } else if (algorithm == "Nearest Neighbor (k-d tree)") {
+                auto result = nearestNeighbourKdTree(coordinates, matrix, n);
+                route = result.first;
+                length = result.second;
+            } else if (algorithm == "Greedy Edge") {
+                auto result = greedyEdge(coordinates, matrix, n);
+                route = result.first;
+                length = result.second;
+            } else {
+                cerr << "Skipping unknown algorithm " << algorithm << endl;
+                continue;
             }
 
             auto end = chrono::high_resolution_clock::now();
@@ -334,9 +4253,13 @@ int main(int argc, char* argv[]) {
                 {"duration", length},
                 {"time", duration.count()},
             };
+            if (lowerBound > 0) {
+                results[algorithm]["gap"] = (length - lowerBound) / lowerBound * 100; // Percent above the lower bound
+            }
 
         }
         results["size"] = n;
+        results["seed"] = seed;
         // Write results to a JSON file (into the "output" folder)
         outputFilename = "output/output_" + to_string(i) + ".json";
         ofstream outputFile(outputFilename);
@@ -352,3 +4275,4 @@ int main(int argc, char* argv[]) {
 
     return 0;
 }
+#endif // TSP_NO_MAIN
@@ -0,0 +1,199 @@
+/**
+ * @file tsp_native.cpp
+ * @brief CPython extension module exposing the C++ TSP solvers to main.py.
+ *
+ * The module tsp_native provides nearest_neighbour, brute_force, held_karp and
+ * ant_colony_optimization with the same signatures and results as solve_tsp.py. Matrices that
+ * support the buffer protocol with float64 entries (NumPy arrays) are read in place without
+ * copying; nested lists such as the openrouteservice durations are copied once. The GIL is
+ * released while a solver runs.
+ *
+ * Build (Linux/macOS):
+ *   g++ -O2 -std=c++17 -shared -fPIC $(python3-config --includes) tsp_native.cpp -o tsp_native$(python3-config --extension-suffix)
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <memory>
+
+#define TSP_NO_MAIN
+#include "solve_tsp.cpp"
+
+/**
+ * @brief Distance matrix passed from Python, either borrowed from a buffer or copied from lists.
+ */
+struct PythonMatrix {
+    Py_buffer buffer{};            ///< Buffer view of the matrix when it supports the protocol
+    bool hasBuffer = false;
+    vector<vector<double>> copy;   ///< Entries copied from nested sequences otherwise
+
+    ~PythonMatrix() {
+        if (hasBuffer) PyBuffer_Release(&buffer);
+    }
+};
+
+/**
+ * @brief Converts a Python object into a matrix view of size n x n.
+ * @param object A 2D float64 buffer or a sequence of sequences of numbers.
+ * @param n The number of nodes.
+ * @param matrix Holds the borrowed buffer or the copied entries.
+ * @param view Receives the view over the entries.
+ * @return True on success; otherwise a Python exception is set.
+ */
+static bool toMatrixView(PyObject* object, int n, PythonMatrix& matrix, unique_ptr<MatrixView>& view) {
+    if (n < 1) {
+        PyErr_SetString(PyExc_ValueError, "n must be positive");
+        return false;
+    }
+
+    if (PyObject_CheckBuffer(object)) {
+        if (PyObject_GetBuffer(object, &matrix.buffer, PyBUF_STRIDES | PyBUF_FORMAT) != 0) return false;
+        matrix.hasBuffer = true;
+        const Py_buffer& buffer = matrix.buffer;
+        if (buffer.ndim != 2 || buffer.format == nullptr || string(buffer.format) != "d") {
+            PyErr_SetString(PyExc_TypeError, "matrix must be a 2D float64 array");
+            return false;
+        }
+        if (buffer.shape[0] < n || buffer.shape[1] < n) {
+            PyErr_SetString(PyExc_ValueError, "matrix is smaller than n x n");
+            return false;
+        }
+        if (buffer.strides[1] != sizeof(double) || buffer.strides[0] % sizeof(double) != 0) {
+            PyErr_SetString(PyExc_ValueError, "matrix rows must be contiguous");
+            return false;
+        }
+        view = make_unique<MatrixView>(static_cast<const double*>(buffer.buf), n, buffer.strides[0] / static_cast<Py_ssize_t>(sizeof(double)));
+        return true;
+    }
+
+    PyObject* rows = PySequence_Fast(object, "matrix must be a 2D array or a sequence of sequences");
+    if (rows == nullptr) return false;
+    if (PySequence_Fast_GET_SIZE(rows) < n) {
+        Py_DECREF(rows);
+        PyErr_SetString(PyExc_ValueError, "matrix is smaller than n x n");
+        return false;
+    }
+
+    matrix.copy.assign(n, vector<double>(n));
+    for (int i = 0; i < n; ++i) {
+        PyObject* row = PySequence_Fast(PySequence_Fast_GET_ITEM(rows, i), "matrix rows must be sequences");
+        if (row == nullptr || PySequence_Fast_GET_SIZE(row) < n) {
+            if (row != nullptr) {
+                Py_DECREF(row);
+                PyErr_SetString(PyExc_ValueError, "matrix is smaller than n x n");
+            }
+            Py_DECREF(rows);
+            return false;
+        }
+        for (int j = 0; j < n; ++j) {
+            matrix.copy[i][j] = PyFloat_AsDouble(PySequence_Fast_GET_ITEM(row, j));
+        }
+        Py_DECREF(row);
+        if (PyErr_Occurred()) {
+            Py_DECREF(rows);
+            return false;
+        }
+    }
+    Py_DECREF(rows);
+    view = make_unique<MatrixView>(matrix.copy);
+    return true;
+}
+
+/**
+ * @brief Builds the (route, duration) tuple returned to Python.
+ */
+static PyObject* toPython(const pair<vector<int>, double>& result) {
+    PyObject* route = PyList_New(static_cast<Py_ssize_t>(result.first.size()));
+    if (route == nullptr) return nullptr;
+    for (size_t i = 0; i < result.first.size(); ++i) {
+        PyList_SET_ITEM(route, static_cast<Py_ssize_t>(i), PyLong_FromLong(result.first[i]));
+    }
+    return Py_BuildValue("(Nd)", route, result.second);
+}
+
+/**
+ * @brief Runs a solver on a matrix with the GIL released and converts the result.
+ * @param object The matrix passed from Python.
+ * @param n The number of nodes.
+ * @param solve Callable taking the matrix view and returning a (route, duration) pair.
+ */
+template <typename Solver>
+static PyObject* runSolver(PyObject* object, int n, Solver solve) {
+    PythonMatrix matrix;
+    unique_ptr<MatrixView> view;
+    if (!toMatrixView(object, n, matrix, view)) return nullptr;
+
+    pair<vector<int>, double> result;
+    bool outOfMemory = false;
+    Py_BEGIN_ALLOW_THREADS
+    try {
+        result = solve(*view);
+    } catch (const bad_alloc&) {
+        outOfMemory = true;
+    }
+    Py_END_ALLOW_THREADS
+
+    if (outOfMemory) return PyErr_NoMemory();
+    return toPython(result);
+}
+
+static PyObject* nearest_neighbour(PyObject*, PyObject* args) {
+    PyObject* object;
+    int n;
+    if (!PyArg_ParseTuple(args, "Oi", &object, &n)) return nullptr;
+    return runSolver(object, n, [n](const MatrixView& matrix) { return nearestNeighbour(matrix, n); });
+}
+
+static PyObject* brute_force(PyObject*, PyObject* args) {
+    PyObject* object;
+    int n;
+    if (!PyArg_ParseTuple(args, "Oi", &object, &n)) return nullptr;
+    return runSolver(object, n, [n](const MatrixView& matrix) { return bruteForce(matrix, n); });
+}
+
+static PyObject* held_karp(PyObject*, PyObject* args) {
+    PyObject* object;
+    int n;
+    if (!PyArg_ParseTuple(args, "Oi", &object, &n)) return nullptr;
+    return runSolver(object, n, [n](const MatrixView& matrix) { return heldKarp(matrix, n); });
+}
+
+static PyObject* ant_colony_optimization(PyObject*, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = {"matrix", "n", "num_ants", "num_iterations", "alpha", "beta", "evaporation_rate", "seed", nullptr};
+    PyObject* object;
+    int n;
+    AcoParameters parameters;
+    unsigned long long seed = parameters.seed;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "Oi|iidddK", const_cast<char**>(keywords), &object, &n,
+                                     &parameters.numAnts, &parameters.numIterations, &parameters.alpha, &parameters.beta,
+                                     &parameters.evaporationRate, &seed)) {
+        return nullptr;
+    }
+    parameters.seed = seed;
+    return runSolver(object, n, [=](const MatrixView& matrix) { return antColonyOptimization(matrix, n, parameters); });
+}
+
+static PyMethodDef methods[] = {
+    {"nearest_neighbour", nearest_neighbour, METH_VARARGS, "nearest_neighbour(matrix, n) -> (route, duration)"},
+    {"brute_force", brute_force, METH_VARARGS, "brute_force(matrix, n) -> (route, duration)"},
+    {"held_karp", held_karp, METH_VARARGS, "held_karp(matrix, n) -> (route, duration)"},
+    {"ant_colony_optimization", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)(void)>(ant_colony_optimization)), METH_VARARGS | METH_KEYWORDS,
+     "ant_colony_optimization(matrix, n, num_ants=100, num_iterations=10, alpha=1.0, beta=2.0, evaporation_rate=0.5, seed=<random>) -> (route, duration)"},
+    {nullptr, nullptr, 0, nullptr}
+};
+
+static PyModuleDef module = {
+    PyModuleDef_HEAD_INIT,
+    "tsp_native",
+    "Native TSP solvers from solve_tsp.cpp",
+    -1,
+    methods,
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr
+};
+
+PyMODINIT_FUNC PyInit_tsp_native(void) {
+    return PyModule_Create(&module);
+}